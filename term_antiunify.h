@@ -0,0 +1,80 @@
+#ifndef TERM_ANTIUNIFY_H
+#define TERM_ANTIUNIFY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "term_unification.h"
+
+// ------------------------------ AntiUnifier -------------------------------
+// Least general generalization (anti-unification): the most specific term G such that
+// every input is an instance of G. Positions where all inputs agree on a functor and
+// arity keep it; every other position becomes a fresh variable, and positions holding
+// the same tuple of subterms share one variable, so lgg(f(a, a), f(b, b)) is f(_G0, _G0)
+// and not f(_G0, _G1). Input variables count as fixed symbols: lgg(X, X) is X.
+// The inputs are walked once, all of them side by side, with an explicit stack.
+// Not thread-safe; use one AntiUnifier per thread like Unifier.
+class AntiUnifier {
+public:
+    struct Generalization {
+        std::unique_ptr<Term<std::string>> term;
+
+        // substitutions[i] maps each fresh variable of term to the subterm it stands for
+        // in input i, so applying it to term gives back input i.
+        std::vector<Unifier::Substitution> substitutions;
+    };
+
+    // Fresh variables are named prefix followed by 0, 1, ... in preorder, restarting for
+    // every call; choose a prefix that no input variable starts with.
+    explicit AntiUnifier(std::string prefix = "_G");
+    AntiUnifier(const AntiUnifier&) = delete;
+    AntiUnifier& operator=(const AntiUnifier&) = delete;
+
+    Generalization generalize(const Term<std::string>& t1, const Term<std::string>& t2);
+
+    // Generalization of all terms; throws std::invalid_argument if terms is empty.
+    Generalization generalize(const std::vector<const Term<std::string>*>& terms);
+
+    const std::string& prefix() const noexcept;
+
+private:
+    std::string prefix_;
+
+    // Scratch reused across calls.
+    // A position to be generalized is the index of its tuple: its subterm in each input
+    // is tuples_[first .. first + inputs).
+    std::vector<const Term<std::string>*> tuples_;
+    TermCloner<std::size_t> cloner_;
+    std::unordered_map<std::string, std::size_t> fresh_;  // tuple key -> variable index
+    std::vector<std::size_t> freshTuples_;                // variable index -> tuple start
+    std::vector<const Term<std::string>*> keyScan_;
+    std::string key_;
+
+    // Functor and arity shared by every term of the tuple at first, or nullptr when the
+    // tuple is not all compounds of one shape.
+    const Compound<std::string>* commonCompound(std::size_t first, std::size_t inputs) const;
+
+    // True when every term of the tuple is the same constant or the same variable.
+    bool commonLeaf(std::size_t first, std::size_t inputs) const;
+
+    // Structural key of the tuple at first, for sharing variables between equal tuples.
+    const std::string& tupleKey(std::size_t first, std::size_t inputs);
+    void appendWord(std::uint64_t word);
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline AntiUnifier::Generalization AntiUnifier::generalize(const Term<std::string>& t1,
+                                                           const Term<std::string>& t2) {
+    return generalize(std::vector<const Term<std::string>*>{&t1, &t2});
+}
+
+inline const std::string& AntiUnifier::prefix() const noexcept {
+    return prefix_;
+}
+
+#endif // TERM_ANTIUNIFY_H
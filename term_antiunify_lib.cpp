@@ -0,0 +1,142 @@
+#include "term_antiunify.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+AntiUnifier::AntiUnifier(std::string prefix) : prefix_(std::move(prefix)) {}
+
+AntiUnifier::Generalization AntiUnifier::generalize(
+    const std::vector<const Term<std::string>*>& terms) {
+    if (terms.empty()) {
+        throw std::invalid_argument("AntiUnifier::generalize needs at least one term");
+    }
+    const std::size_t inputs = terms.size();
+    tuples_.assign(terms.begin(), terms.end());
+    fresh_.clear();
+    freshTuples_.clear();
+
+    // each node is the start of a tuple in tuples_; argument tuples are appended to
+    // tuples_ as compounds expand
+    Generalization result;
+    result.term = cloner_.build(0, [&](std::size_t first, auto& step) {
+        if (const Compound<std::string>* shape = commonCompound(first, inputs)) {
+            const std::size_t base = tuples_.size();
+            const std::size_t arity = shape->arity();
+            tuples_.resize(base + arity * inputs);
+            for (std::size_t k = 0; k < inputs; ++k) {
+                const auto& comp = termCast<Compound<std::string>>(*tuples_[first + k]);
+                for (std::size_t i = 0; i < arity; ++i) {
+                    tuples_[base + i * inputs + k] = &comp.arg(i);
+                }
+            }
+            step.compound(*shape);
+            for (std::size_t i = 0; i < arity; ++i) {
+                step.child(base + i * inputs);
+            }
+            return;
+        }
+
+        if (commonLeaf(first, inputs)) {
+            step.leaf(tuples_[first]->clone());
+            return;
+        }
+
+        auto [it, added] = fresh_.try_emplace(tupleKey(first, inputs), freshTuples_.size());
+        if (added) {
+            freshTuples_.push_back(first);
+        }
+        step.leaf(std::make_unique<Variable>(prefix_ + std::to_string(it->second)));
+    });
+
+    result.substitutions.resize(inputs);
+    for (std::size_t v = 0; v < freshTuples_.size(); ++v) {
+        const std::string name = prefix_ + std::to_string(v);
+        for (std::size_t k = 0; k < inputs; ++k) {
+            result.substitutions[k].emplace(name, tuples_[freshTuples_[v] + k]->clone());
+        }
+    }
+    return result;
+}
+
+const Compound<std::string>* AntiUnifier::commonCompound(std::size_t first,
+                                                         std::size_t inputs) const {
+    const Term<std::string>& head = *tuples_[first];
+    if (!head.isCompound()) {
+        return nullptr;
+    }
+    const auto& shape = termCast<Compound<std::string>>(head);
+    for (std::size_t k = 1; k < inputs; ++k) {
+        const Term<std::string>& other = *tuples_[first + k];
+        if (!other.isCompound()) {
+            return nullptr;
+        }
+        const auto& comp = termCast<Compound<std::string>>(other);
+        if (comp.functorId() != shape.functorId() || comp.arity() != shape.arity()) {
+            return nullptr;
+        }
+    }
+    return &shape;
+}
+
+bool AntiUnifier::commonLeaf(std::size_t first, std::size_t inputs) const {
+    const Term<std::string>& head = *tuples_[first];
+    if (head.isCompound()) {
+        return false;
+    }
+    const SymbolId id = head.isVariable() ? termCast<Variable>(head).id()
+                                          : termCast<Constant>(head).id();
+    for (std::size_t k = 1; k < inputs; ++k) {
+        const Term<std::string>& other = *tuples_[first + k];
+        if (other.kind() != head.kind()) {
+            return false;
+        }
+        const SymbolId otherId = other.isVariable() ? termCast<Variable>(other).id()
+                                                    : termCast<Constant>(other).id();
+        if (otherId != id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string& AntiUnifier::tupleKey(std::size_t first, std::size_t inputs) {
+    // every term in preorder with symbols as IDs; arities make it self-delimiting, so the
+    // terms can simply follow each other
+    key_.clear();
+    keyScan_.clear();
+    for (std::size_t k = inputs; k > 0; --k) {
+        keyScan_.push_back(tuples_[first + k - 1]);
+    }
+    while (!keyScan_.empty()) {
+        const Term<std::string>& term = *keyScan_.back();
+        keyScan_.pop_back();
+        switch (term.kind()) {
+        case TermKind::Variable:
+            appendWord(static_cast<std::uint64_t>(termCast<Variable>(term).id()) << 2 |
+                       static_cast<std::uint64_t>(TermKind::Variable));
+            break;
+        case TermKind::Constant:
+            appendWord(static_cast<std::uint64_t>(termCast<Constant>(term).id()) << 2 |
+                       static_cast<std::uint64_t>(TermKind::Constant));
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(term);
+            appendWord(static_cast<std::uint64_t>(comp.functorId()) << 2 |
+                       static_cast<std::uint64_t>(TermKind::Compound));
+            appendWord(comp.arity());
+            for (std::size_t i = comp.arity(); i > 0; --i) {
+                keyScan_.push_back(&comp.arg(i - 1));
+            }
+            break;
+        }
+        }
+    }
+    return key_;
+}
+
+void AntiUnifier::appendWord(std::uint64_t word) {
+    char bytes[sizeof word];
+    std::memcpy(bytes, &word, sizeof word);
+    key_.append(bytes, sizeof word);
+}
@@ -0,0 +1,89 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "term_antiunify.h"
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Formatted lgg of the given texts.
+std::string generalized(AntiUnifier& anti, const std::vector<std::string>& texts) {
+    std::vector<TermPtr> owned;
+    std::vector<const Term<std::string>*> terms;
+    for (const std::string& text : texts) {
+        owned.push_back(parseTerm(text));
+        terms.push_back(owned.back().get());
+    }
+    return formatTerm(*anti.generalize(terms).term);
+}
+
+void testGeneralize() {
+    AntiUnifier anti;
+    CHECK_EQ(generalized(anti, {"f(a, b)", "f(a, c)"}), "f(a, _G0)");
+    CHECK_EQ(generalized(anti, {"f(a)", "g(a)"}), "_G0");
+    CHECK_EQ(generalized(anti, {"f(a)", "f(a, b)"}), "_G0");
+    CHECK_EQ(generalized(anti, {"X", "X"}), "X");
+    CHECK_EQ(generalized(anti, {"p(g(a), h(b))", "p(g(c), h(d))", "p(g(e), h(b))"}),
+             "p(g(_G0), h(_G1))");
+    CHECK_EQ(generalized(anti, {"k(a)"}), "k(a)");
+    CHECK_THROWS(anti.generalize(std::vector<const Term<std::string>*>{}),
+                 std::invalid_argument);
+}
+
+// Equal tuples of differing subterms share one variable; different tuples do not.
+void testSharing() {
+    AntiUnifier anti;
+    CHECK_EQ(generalized(anti, {"f(a, a)", "f(b, b)"}), "f(_G0, _G0)");
+    CHECK_EQ(generalized(anti, {"f(a, b)", "f(b, a)"}), "f(_G0, _G1)");
+    CHECK_EQ(generalized(anti, {"f(g(a), x, g(a))", "f(h, y, h)"}), "f(_G0, _G1, _G0)");
+}
+
+// Applying substitutions[i] to the generalization gives back input i.
+void testSubstitutions() {
+    AntiUnifier anti("V");
+    TermPtr t1 = parseTerm("f(g(a), b, g(a))");
+    TermPtr t2 = parseTerm("f(c, b, c)");
+    AntiUnifier::Generalization lgg = anti.generalize(*t1, *t2);
+    CHECK_EQ(formatTerm(*lgg.term), "f(V0, b, V0)");
+    CHECK_EQ(lgg.substitutions.size(), 2u);
+    CHECK_EQ(formatSubstitution(lgg.substitutions[0]), "V0 -> g(a)");
+    CHECK_EQ(formatSubstitution(lgg.substitutions[1]), "V0 -> c");
+
+    Unifier unifier;
+    CHECK_EQ(formatTerm(*unifier.substitute(*lgg.term, lgg.substitutions[0])), formatTerm(*t1));
+    CHECK_EQ(formatTerm(*unifier.substitute(*lgg.term, lgg.substitutions[1])), formatTerm(*t2));
+}
+
+// The inputs are walked with an explicit stack.
+void testDeep() {
+    constexpr int kDepth = 100000;
+    TermPtr t1 = builders::constant("a");
+    TermPtr t2 = builders::constant("b");
+    for (int i = 0; i < kDepth; ++i) {
+        t1 = builders::compound("s", std::move(t1));
+        t2 = builders::compound("s", std::move(t2));
+    }
+    AntiUnifier anti;
+    AntiUnifier::Generalization lgg = anti.generalize(*t1, *t2);
+    const Term<std::string>* node = lgg.term.get();
+    int depth = 0;
+    while (node->isCompound()) {
+        node = &termCast<Compound<std::string>>(*node).arg(0);
+        ++depth;
+    }
+    CHECK_EQ(depth, kDepth);
+    CHECK(node->isVariable());
+}
+
+int main() {
+    testGeneralize();
+    testSharing();
+    testSubstitutions();
+    testDeep();
+    return testSummary();
+}
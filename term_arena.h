@@ -0,0 +1,95 @@
+#ifndef TERM_ARENA_H
+#define TERM_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// ------------------------------- TermArena --------------------------------
+// Bump allocator for the scratch state of unification (bindings, work lists).
+// Deallocation is a no-op; memory comes back all at once through rewind() or release().
+// Blocks are kept after rewinding, so a warmed-up arena serves every later call
+// without touching the upstream allocator.
+// Usable anywhere a std::pmr::memory_resource is expected. Not thread-safe.
+class TermArena : public std::pmr::memory_resource {
+public:
+    // Position in the arena; rewinding to it frees everything allocated afterwards.
+    struct Mark {
+        std::size_t block;
+        std::size_t offset;
+    };
+
+    // Rewinds the arena to its position at construction when it goes out of scope.
+    class Scope {
+    private:
+        TermArena& arena_;
+        Mark mark_;
+
+    public:
+        explicit Scope(TermArena& arena) noexcept;
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+    };
+
+    explicit TermArena(std::size_t blockSize = 4096,
+                       std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    TermArena(const TermArena&) = delete;
+    TermArena& operator=(const TermArena&) = delete;
+    ~TermArena() override;
+
+    Mark mark() const noexcept;
+
+    // Frees everything allocated after m. Objects living there must already be destroyed.
+    void rewind(Mark m) noexcept;
+
+    // Frees everything, keeping the blocks for reuse.
+    void release() noexcept;
+
+    // Bytes handed out since the last release (including alignment padding).
+    std::size_t bytesUsed() const noexcept;
+
+    // Bytes obtained from upstream and still held.
+    std::size_t bytesReserved() const noexcept;
+
+private:
+    struct Block {
+        std::byte* data;
+        std::size_t size;
+    };
+
+    std::size_t blockSize_;
+    std::pmr::memory_resource* upstream_;
+    std::vector<Block> blocks_;
+    std::size_t current_ = 0;  // index of the block being filled
+    std::size_t offset_ = 0;   // bytes used in blocks_[current_]
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline TermArena::Scope::Scope(TermArena& arena) noexcept
+    : arena_(arena), mark_(arena.mark()) {}
+
+inline TermArena::Scope::~Scope() {
+    arena_.rewind(mark_);
+}
+
+inline TermArena::Mark TermArena::mark() const noexcept {
+    return Mark{current_, offset_};
+}
+
+inline void TermArena::rewind(Mark m) noexcept {
+    current_ = m.block;
+    offset_ = m.offset;
+}
+
+inline void TermArena::release() noexcept {
+    current_ = 0;
+    offset_ = 0;
+}
+
+#endif // TERM_ARENA_H
@@ -0,0 +1,60 @@
+#include "term_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+TermArena::TermArena(std::size_t blockSize, std::pmr::memory_resource* upstream)
+    : blockSize_(blockSize), upstream_(upstream) {}
+
+TermArena::~TermArena() {
+    for (const Block& block : blocks_) {
+        upstream_->deallocate(block.data, block.size, alignof(std::max_align_t));
+    }
+}
+
+std::size_t TermArena::bytesUsed() const noexcept {
+    std::size_t used = offset_;
+    for (std::size_t i = 0; i < current_ && i < blocks_.size(); ++i) {
+        used += blocks_[i].size;
+    }
+    return used;
+}
+
+std::size_t TermArena::bytesReserved() const noexcept {
+    std::size_t reserved = 0;
+    for (const Block& block : blocks_) {
+        reserved += block.size;
+    }
+    return reserved;
+}
+
+void* TermArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    while (current_ < blocks_.size()) {
+        const Block& block = blocks_[current_];
+        const auto base = reinterpret_cast<std::uintptr_t>(block.data);
+        const std::size_t start = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+        if (start + bytes <= block.size) {
+            offset_ = start + bytes;
+            return block.data + start;
+        }
+        // move on to the next kept block; its tail beyond offset_ is simply skipped
+        ++current_;
+        offset_ = 0;
+    }
+
+    // out of kept blocks: grab a new one big enough for this request
+    const std::size_t size = std::max(blockSize_, bytes + alignment);
+    auto* data = static_cast<std::byte*>(upstream_->allocate(size, alignof(std::max_align_t)));
+    blocks_.push_back(Block{data, size});
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return do_allocate(bytes, alignment);
+}
+
+void TermArena::do_deallocate(void*, std::size_t, std::size_t) {
+    // memory is reclaimed by rewind()/release()
+}
+
+bool TermArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+#include "term_arena.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Upstream resource that counts the allocations it serves.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+void testAllocate() {
+    CountingResource upstream;
+    TermArena arena(256, &upstream);
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(16, 16);
+    CHECK(reinterpret_cast<std::uintptr_t>(b) % 16 == 0);
+    CHECK(a != b);
+    CHECK(arena.bytesUsed() >= 19u);
+    CHECK_EQ(upstream.allocations, 1u);
+
+    const TermArena::Mark mark = arena.mark();
+    const std::size_t used = arena.bytesUsed();
+    CHECK(arena.allocate(200, 8) != nullptr);
+    CHECK(arena.allocate(1000, 8) != nullptr);  // larger than a block
+    CHECK(arena.bytesUsed() >= used + 1200);
+    arena.rewind(mark);
+    CHECK_EQ(arena.bytesUsed(), used);
+
+    {
+        TermArena::Scope scope(arena);
+        CHECK(arena.allocate(64, 8) != nullptr);
+    }
+    const std::size_t reserved = arena.bytesReserved();
+    const std::size_t served = upstream.allocations;
+    arena.release();
+    CHECK_EQ(arena.bytesUsed(), 0u);
+    // blocks are kept, so refilling the same amount asks upstream for nothing
+    CHECK(arena.allocate(200, 8) != nullptr);
+    CHECK(arena.allocate(1000, 8) != nullptr);
+    CHECK_EQ(upstream.allocations, served);
+    CHECK_EQ(arena.bytesReserved(), reserved);
+}
+
+// A plain Unifier grows its scratch bindings on the default resource; on an arena the
+// same calls take them from the arena, and once warmed up nothing reaches upstream.
+void testUnifierScratch() {
+    TermPtr lhs = parseTerm("f(X, g(Y, Z), h(Z, W), W)");
+    TermPtr rhs = parseTerm("f(a, g(b, c), h(c, d), d)");
+    CountingResource heap;
+    std::pmr::memory_resource* const previous = std::pmr::set_default_resource(&heap);
+
+    std::size_t baseline = 0;
+    {
+        Unifier plain;
+        CHECK(plain.unify(*lhs, *rhs).has_value());
+        baseline = heap.allocations;
+    }
+    CHECK(baseline > 0u);
+
+    CountingResource upstream;
+    TermArena arena(4096, &upstream);
+    {
+        Unifier unifier(arena);
+        CHECK(unifier.unify(*lhs, *rhs).has_value());
+        CHECK_EQ(heap.allocations, baseline);  // nothing more from the default resource
+        CHECK(arena.bytesUsed() > 0u);
+        const std::size_t used = arena.bytesUsed();
+        const std::size_t warmed = upstream.allocations;
+        bool same = true;
+        for (int i = 0; i < 100; ++i) {
+            same = same && unifier.unify(*lhs, *rhs).has_value();
+        }
+        CHECK(same);
+        CHECK_EQ(upstream.allocations, warmed);
+        CHECK_EQ(arena.bytesUsed(), used);  // the bindings were reused, not regrown
+    }
+    std::pmr::set_default_resource(previous);
+}
+
+int main() {
+    testAllocate();
+    testUnifierScratch();
+    return testSummary();
+}
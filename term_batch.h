@@ -0,0 +1,136 @@
+#ifndef TERM_BATCH_H
+#define TERM_BATCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "term_arena.h"
+#include "term_unification.h"
+
+// ------------------------------- ThreadPool -------------------------------
+// Fixed-size pool with one task deque per worker. Workers take chunks from the front of
+// their own deque and, once it is empty, steal from the back of the others.
+// The thread calling parallelFor takes part as worker 0, so a pool of size 1 runs
+// everything inline without starting any thread.
+class ThreadPool {
+public:
+    // Chunk body: called with the worker index and a half-open index range.
+    using RangeFn = std::function<void(std::size_t worker, std::size_t begin, std::size_t end)>;
+
+    explicit ThreadPool(std::size_t workers = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    // Number of workers, including the calling thread.
+    std::size_t size() const noexcept;
+
+    // Runs body over [0, count) in chunks of at most grain indices and returns when all
+    // chunks are done. One call at a time; concurrent callers are serialized.
+    // If body throws, the chunks not yet started are skipped, the call still waits for
+    // the ones in flight, and the first exception is rethrown on the calling thread.
+    void parallelFor(std::size_t count, std::size_t grain, const RangeFn& body);
+
+private:
+    struct Chunk {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    const RangeFn* body_ = nullptr;
+    std::atomic<std::size_t> remaining_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;  // first exception thrown by body_, guarded by state_
+
+    std::mutex submit_;  // serializes parallelFor calls
+    std::mutex state_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::size_t generation_ = 0;
+    bool stop_ = false;
+
+    void workerLoop(std::size_t worker);
+    void runChunks(std::size_t worker);
+    bool popLocal(std::size_t worker, Chunk& chunk);
+    bool steal(std::size_t worker, Chunk& chunk);
+};
+
+// ------------------------------ BatchUnifier ------------------------------
+// Unifies many independent term pairs in parallel. Every worker owns its Unifier and
+// TermArena, so workers share nothing but the (read-only) input terms.
+// Results come back in input order.
+class BatchUnifier {
+public:
+    using TermPair = Unifier::TermPair;
+    using Results = std::vector<std::optional<Unifier::Substitution>>;
+
+    explicit BatchUnifier(std::size_t workers = std::thread::hardware_concurrency(),
+                          OccursCheck policy = OccursCheck::Full);
+
+    // results[i] is the unifier of pairs[i].first and pairs[i].second.
+    Results unifyAll(const TermPair* pairs, std::size_t count);
+    Results unifyAll(const std::vector<TermPair>& pairs);
+
+    // results[i] is the unifier of goal and *candidates[i].
+    Results unifyAgainst(const Term<std::string>& goal,
+                         const Term<std::string>* const* candidates,
+                         std::size_t count);
+    Results unifyAgainst(const Term<std::string>& goal,
+                         const std::vector<const Term<std::string>*>& candidates);
+
+    std::size_t workers() const noexcept;
+
+private:
+    // Per-worker state, allocated separately and aligned so workers never share a cache line.
+    struct alignas(64) Worker {
+        TermArena arena;
+        Unifier unifier;
+
+        explicit Worker(OccursCheck policy);
+    };
+
+    ThreadPool pool_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // Chunk size giving each worker several chunks, so stealing can even out the load.
+    std::size_t grainFor(std::size_t count) const noexcept;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline std::size_t ThreadPool::size() const noexcept {
+    return queues_.size();
+}
+
+inline BatchUnifier::Results BatchUnifier::unifyAll(const std::vector<TermPair>& pairs) {
+    return unifyAll(pairs.data(), pairs.size());
+}
+
+inline BatchUnifier::Results BatchUnifier::unifyAgainst(
+    const Term<std::string>& goal, const std::vector<const Term<std::string>*>& candidates) {
+    return unifyAgainst(goal, candidates.data(), candidates.size());
+}
+
+inline std::size_t BatchUnifier::workers() const noexcept {
+    return pool_.size();
+}
+
+#endif // TERM_BATCH_H
@@ -0,0 +1,163 @@
+#include "term_batch.h"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(std::size_t workers) {
+    workers = std::max<std::size_t>(workers, 1);
+    queues_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    // worker 0 is whichever thread calls parallelFor
+    threads_.reserve(workers - 1);
+    for (std::size_t i = 1; i < workers; ++i) {
+        threads_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain, const RangeFn& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    std::lock_guard<std::mutex> submit(submit_);
+
+    // deal chunks round-robin so every worker starts with local work
+    body_ = &body;
+    failed_.store(false);
+    error_ = nullptr;
+    const std::size_t chunks = (count + grain - 1) / grain;
+    remaining_.store(chunks);
+    for (std::size_t c = 0; c < chunks; ++c) {
+        Queue& queue = *queues_[c % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.push_back(Chunk{c * grain, std::min(count, (c + 1) * grain)});
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    runChunks(0);
+    std::unique_lock<std::mutex> lock(state_);
+    done_.wait(lock, [this] { return remaining_.load() == 0; });
+    body_ = nullptr;
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+void ThreadPool::workerLoop(std::size_t worker) {
+    std::size_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        runChunks(worker);
+    }
+}
+
+void ThreadPool::runChunks(std::size_t worker) {
+    Chunk chunk{};
+    while (popLocal(worker, chunk) || steal(worker, chunk)) {
+        // after a failure the remaining chunks are only counted down, not run
+        if (!failed_.load(std::memory_order_relaxed)) {
+            try {
+                (*body_)(worker, chunk.begin, chunk.end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (remaining_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(state_);
+            done_.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::popLocal(std::size_t worker, Chunk& chunk) {
+    Queue& queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty()) {
+        return false;
+    }
+    chunk = queue.chunks.front();
+    queue.chunks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t worker, Chunk& chunk) {
+    for (std::size_t offset = 1; offset < queues_.size(); ++offset) {
+        Queue& victim = *queues_[(worker + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+BatchUnifier::Worker::Worker(OccursCheck policy) : unifier(arena) {
+    unifier.setOccursCheck(policy);
+}
+
+BatchUnifier::BatchUnifier(std::size_t workers, OccursCheck policy) : pool_(workers) {
+    workers_.reserve(pool_.size());
+    for (std::size_t i = 0; i < pool_.size(); ++i) {
+        workers_.push_back(std::make_unique<Worker>(policy));
+    }
+}
+
+BatchUnifier::Results BatchUnifier::unifyAll(const TermPair* pairs, std::size_t count) {
+    Results results(count);
+    pool_.parallelFor(count, grainFor(count),
+                      [&](std::size_t worker, std::size_t begin, std::size_t end) {
+                          Unifier& unifier = workers_[worker]->unifier;
+                          for (std::size_t i = begin; i < end; ++i) {
+                              results[i] = unifier.unify(*pairs[i].first, *pairs[i].second);
+                          }
+                      });
+    return results;
+}
+
+BatchUnifier::Results BatchUnifier::unifyAgainst(const Term<std::string>& goal,
+                                                 const Term<std::string>* const* candidates,
+                                                 std::size_t count) {
+    Results results(count);
+    pool_.parallelFor(count, grainFor(count),
+                      [&](std::size_t worker, std::size_t begin, std::size_t end) {
+                          Unifier& unifier = workers_[worker]->unifier;
+                          for (std::size_t i = begin; i < end; ++i) {
+                              results[i] = unifier.unify(goal, *candidates[i]);
+                          }
+                      });
+    return results;
+}
+
+std::size_t BatchUnifier::grainFor(std::size_t count) const noexcept {
+    return std::max<std::size_t>(1, count / (pool_.size() * 8));
+}
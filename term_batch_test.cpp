@@ -0,0 +1,135 @@
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "term_batch.h"
+#include "term_format.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Every index is visited exactly once, whatever the pool size and grain.
+void testCoverage() {
+    for (std::size_t workers : {1, 2, 4}) {
+        ThreadPool pool(workers);
+        CHECK_EQ(pool.size(), workers);
+        for (std::size_t grain : {1, 3, 64}) {
+            // checks are not thread-safe, so workers only record what they saw
+            std::vector<std::atomic<int>> seen(1000);
+            std::atomic<bool> bounded{true};
+            pool.parallelFor(seen.size(), grain, [&](std::size_t worker, std::size_t begin,
+                                                     std::size_t end) {
+                if (worker >= workers || end - begin > grain) {
+                    bounded.store(false);
+                }
+                for (std::size_t i = begin; i < end; ++i) {
+                    seen[i].fetch_add(1);
+                }
+            });
+            bool once = true;
+            for (const auto& count : seen) {
+                once = once && count.load() == 1;
+            }
+            CHECK(once);
+            CHECK(bounded.load());
+        }
+        pool.parallelFor(0, 1, [](std::size_t, std::size_t, std::size_t) {});
+    }
+}
+
+// An exception thrown by the body reaches the caller after every chunk has drained, and the
+// pool stays usable.
+void testExceptions() {
+    for (std::size_t workers : {1, 4}) {
+        ThreadPool pool(workers);
+        std::atomic<std::size_t> started{0};
+        bool caught = false;
+        try {
+            pool.parallelFor(256, 1, [&](std::size_t, std::size_t begin, std::size_t) {
+                started.fetch_add(1);
+                if (begin % 7 == 3) {
+                    throw std::runtime_error("chunk " + std::to_string(begin));
+                }
+            });
+        } catch (const std::runtime_error& error) {
+            caught = std::string(error.what()).rfind("chunk ", 0) == 0;
+        }
+        CHECK(caught);
+        CHECK(started.load() >= 1);
+        CHECK(started.load() <= 256);
+
+        std::atomic<std::size_t> total{0};
+        pool.parallelFor(100, 10, [&](std::size_t, std::size_t begin, std::size_t end) {
+            total.fetch_add(end - begin);
+        });
+        CHECK_EQ(total.load(), 100u);
+    }
+}
+
+// BatchUnifier gives the same answers as a single Unifier, in input order.
+void testBatchMatchesSequential() {
+    using namespace builders;
+    std::vector<TermPtr> left;
+    std::vector<TermPtr> right;
+    for (int i = 0; i < 500; ++i) {
+        const std::string n = std::to_string(i);
+        left.push_back(compound("p", var("X"), constant(n), var("Y")));
+        if (i % 3 == 0) {
+            right.push_back(compound("p", constant("a"), constant(n), compound("f", var("X"))));
+        } else if (i % 3 == 1) {
+            right.push_back(compound("p", var("Z"), constant("other"), var("Z")));
+        } else {
+            right.push_back(compound("p", compound("g", var("Y")), var("W"), var("Y")));
+        }
+    }
+    std::vector<Unifier::TermPair> pairs;
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        pairs.emplace_back(left[i].get(), right[i].get());
+    }
+
+    Unifier unifier;
+    std::vector<std::string> expected;
+    for (const auto& pair : pairs) {
+        auto result = unifier.unify(*pair.first, *pair.second);
+        expected.push_back(result ? formatSubstitution(*result) : "failure");
+    }
+
+    for (std::size_t workers : {1, 3, 8}) {
+        BatchUnifier batch(workers);
+        const BatchUnifier::Results results = batch.unifyAll(pairs);
+        CHECK_EQ(results.size(), pairs.size());
+        std::size_t same = 0;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const std::string got = results[i] ? formatSubstitution(*results[i]) : "failure";
+            same += got == expected[i] ? 1 : 0;
+        }
+        CHECK_EQ(same, pairs.size());
+    }
+
+    // the occurs check is honoured on every worker
+    TermPtr goal = var("X");
+    std::vector<TermPtr> owned;
+    std::vector<const Term<std::string>*> candidates;
+    for (int i = 0; i < 64; ++i) {
+        owned.push_back(i % 2 == 0 ? compound("f", var("X")) : compound("f", var("Y")));
+        candidates.push_back(owned.back().get());
+    }
+    BatchUnifier batch(4);
+    const BatchUnifier::Results results = batch.unifyAgainst(*goal, candidates);
+    std::size_t rightOutcome = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        rightOutcome += results[i].has_value() == (i % 2 == 1) ? 1 : 0;
+    }
+    CHECK_EQ(rightOutcome, candidates.size());
+}
+
+int main() {
+    testCoverage();
+    testExceptions();
+    testBatchMatchesSequential();
+    return testSummary();
+}
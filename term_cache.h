@@ -0,0 +1,107 @@
+#ifndef TERM_CACHE_H
+#define TERM_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// ------------------------------ UnifyCache --------------------------------
+// LRU memo of unification results, keyed by the canonical form of the input pair:
+// both terms in preorder with symbols as IDs and variables numbered by first
+// occurrence, plus the occurs-check policy. Pairs that differ only in variable names
+// share one entry, and failures are cached like successes.
+// A hit renames the cached substitution to the caller's variables. This can orient a
+// variable-variable binding the other way than a fresh unify would, which is an
+// equally general unifier. Not thread-safe; use one cache per thread like Unifier.
+class UnifyCache {
+public:
+    // Holds at most capacity entries; throws std::invalid_argument for 0.
+    explicit UnifyCache(std::size_t capacity = 4096);
+    UnifyCache(const UnifyCache&) = delete;
+    UnifyCache& operator=(const UnifyCache&) = delete;
+
+    // Result of unifier.unify(t1, t2), served from the cache when an equivalent pair
+    // was seen before; on a miss the result is computed with unifier and stored.
+    std::optional<Unifier::Substitution> unify(const Term<std::string>& t1,
+                                               const Term<std::string>& t2,
+                                               Unifier& unifier);
+
+    std::size_t size() const noexcept;
+    std::size_t capacity() const noexcept;
+
+    // Lookup counters since construction or the last clear().
+    std::size_t hits() const noexcept;
+    std::size_t misses() const noexcept;
+    std::size_t evictions() const noexcept;
+
+    // Drops every entry and zeroes the counters.
+    void clear() noexcept;
+
+private:
+    // One cached pair; variables lists the names of the pair's variables in canonical
+    // order, so they can be mapped onto the variables of a later equivalent pair.
+    struct Entry {
+        std::string key;
+        std::vector<std::string> variables;
+        std::optional<Unifier::Substitution> result;
+    };
+
+    std::size_t capacity_;
+    std::list<Entry> entries_;  // most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;  // views keys
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+    std::size_t evictions_ = 0;
+
+    // Scratch reused across lookups.
+    std::string key_;
+    std::vector<const Variable*> order_;
+    std::unordered_map<SymbolId, std::uint32_t> numbering_;
+    std::vector<const Term<std::string>*> pending_;
+    std::unordered_map<std::string_view, const Variable*> renaming_;  // stored name -> caller
+    mutable TermCloner<const Term<std::string>*> cloner_;
+
+    // Fills key_ and order_ with the canonical form of (t1, t2) under policy.
+    void canonicalize(const Term<std::string>& t1,
+                      const Term<std::string>& t2,
+                      OccursCheck policy);
+    void appendWord(std::uint64_t word);
+
+    // Copy of result with every variable replaced through renaming_ (names only; no
+    // binding is applied).
+    Unifier::Substitution renamed(const Unifier::Substitution& result) const;
+    std::unique_ptr<Term<std::string>> renamedTerm(const Term<std::string>& term) const;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline std::size_t UnifyCache::size() const noexcept {
+    return entries_.size();
+}
+
+inline std::size_t UnifyCache::capacity() const noexcept {
+    return capacity_;
+}
+
+inline std::size_t UnifyCache::hits() const noexcept {
+    return hits_;
+}
+
+inline std::size_t UnifyCache::misses() const noexcept {
+    return misses_;
+}
+
+inline std::size_t UnifyCache::evictions() const noexcept {
+    return evictions_;
+}
+
+#endif // TERM_CACHE_H
@@ -0,0 +1,149 @@
+#include "term_cache.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+UnifyCache::UnifyCache(std::size_t capacity) : capacity_(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("UnifyCache capacity must be positive");
+    }
+}
+
+std::optional<Unifier::Substitution> UnifyCache::unify(const Term<std::string>& t1,
+                                                       const Term<std::string>& t2,
+                                                       Unifier& unifier) {
+    canonicalize(t1, t2, unifier.occursCheck());
+
+    auto found = index_.find(key_);
+    if (found != index_.end()) {
+        ++hits_;
+        entries_.splice(entries_.begin(), entries_, found->second);
+        const Entry& entry = *found->second;
+        if (!entry.result) {
+            return std::nullopt;
+        }
+        // canonical variable k of the stored pair is variable k of this one
+        renaming_.clear();
+        for (std::size_t k = 0; k < entry.variables.size(); ++k) {
+            renaming_.emplace(entry.variables[k], order_[k]);
+        }
+        return renamed(*entry.result);
+    }
+
+    ++misses_;
+    std::optional<Unifier::Substitution> result = unifier.unify(t1, t2);
+
+    Entry entry;
+    entry.key = key_;
+    entry.variables.reserve(order_.size());
+    for (const Variable* var : order_) {
+        entry.variables.push_back(var->name());
+    }
+    if (result) {
+        renaming_.clear();  // plain copy: every variable keeps its name
+        entry.result = renamed(*result);
+    }
+    entries_.push_front(std::move(entry));
+    index_.emplace(entries_.front().key, entries_.begin());
+
+    if (entries_.size() > capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+        ++evictions_;
+    }
+    return result;
+}
+
+void UnifyCache::clear() noexcept {
+    index_.clear();
+    entries_.clear();
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+}
+
+void UnifyCache::canonicalize(const Term<std::string>& t1,
+                              const Term<std::string>& t2,
+                              OccursCheck policy) {
+    key_.clear();
+    order_.clear();
+    numbering_.clear();
+    appendWord(static_cast<std::uint64_t>(policy));
+
+    // preorder of t1 then t2; arities make the sequence self-delimiting
+    pending_.clear();
+    pending_.push_back(&t2);
+    pending_.push_back(&t1);
+    while (!pending_.empty()) {
+        const Term<std::string>& term = *pending_.back();
+        pending_.pop_back();
+
+        switch (term.kind()) {
+        case TermKind::Variable: {
+            const auto& var = termCast<Variable>(term);
+            auto [it, fresh] =
+                numbering_.try_emplace(var.id(), static_cast<std::uint32_t>(order_.size()));
+            if (fresh) {
+                order_.push_back(&var);
+            }
+            appendWord(static_cast<std::uint64_t>(it->second) << 2 |
+                       static_cast<std::uint64_t>(TermKind::Variable));
+            break;
+        }
+        case TermKind::Constant:
+            appendWord(static_cast<std::uint64_t>(termCast<Constant>(term).id()) << 2 |
+                       static_cast<std::uint64_t>(TermKind::Constant));
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(term);
+            appendWord(static_cast<std::uint64_t>(comp.functorId()) << 2 |
+                       static_cast<std::uint64_t>(TermKind::Compound));
+            appendWord(comp.arity());
+            for (std::size_t i = comp.arity(); i > 0; --i) {
+                pending_.push_back(&comp.arg(i - 1));
+            }
+            break;
+        }
+        }
+    }
+}
+
+void UnifyCache::appendWord(std::uint64_t word) {
+    char bytes[sizeof word];
+    std::memcpy(bytes, &word, sizeof word);
+    key_.append(bytes, sizeof word);
+}
+
+Unifier::Substitution UnifyCache::renamed(const Unifier::Substitution& result) const {
+    Unifier::Substitution copy;
+    for (const auto& [name, value] : result) {
+        auto it = renaming_.find(name);
+        copy.emplace(it == renaming_.end() ? name : it->second->name(), renamedTerm(*value));
+    }
+    return copy;
+}
+
+std::unique_ptr<Term<std::string>> UnifyCache::renamedTerm(const Term<std::string>& term) const {
+    return cloner_.build(&term, [this](const Term<std::string>* node, auto& step) {
+        switch (node->kind()) {
+        case TermKind::Variable: {
+            const auto& var = termCast<Variable>(*node);
+            auto it = renaming_.find(var.name());
+            step.leaf(std::make_unique<Variable>(it == renaming_.end() ? var : *it->second));
+            break;
+        }
+        case TermKind::Constant:
+            step.leaf(node->clone());
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(*node);
+            step.compound(comp);
+            for (std::size_t i = 0; i < comp.arity(); ++i) {
+                step.child(&comp.arg(i));
+            }
+            break;
+        }
+        }
+    });
+}
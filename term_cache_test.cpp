@@ -0,0 +1,54 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "term_cache.h"
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Formatted cache.unify(lhs, rhs), or "failure".
+std::string cached(UnifyCache& cache, Unifier& unifier, const std::string& lhs,
+                   const std::string& rhs) {
+    TermPtr t1 = parseTerm(lhs);
+    TermPtr t2 = parseTerm(rhs);
+    auto result = cache.unify(*t1, *t2, unifier);
+    return result ? formatSubstitution(*result) : "failure";
+}
+
+// A pair equal up to variable names is a hit, answered in the caller's variables.
+void testHitsRename() {
+    Unifier unifier;
+    UnifyCache cache(2);
+    CHECK_EQ(cached(cache, unifier, "f(X, g(Y))", "f(a, g(h(X)))"), "X -> a, Y -> h(a)");
+    CHECK_EQ(cached(cache, unifier, "f(P, g(Q))", "f(a, g(h(P)))"), "P -> a, Q -> h(a)");
+    CHECK_EQ(cache.hits(), 1u);
+    CHECK_EQ(cache.misses(), 1u);
+
+    CHECK_EQ(cached(cache, unifier, "a", "b"), "failure");
+    CHECK_EQ(cached(cache, unifier, "a", "b"), "failure");
+    CHECK_EQ(cache.hits(), 2u);
+
+    // a third distinct pair evicts the least recently used one
+    CHECK_EQ(cached(cache, unifier, "k(Z)", "k(c)"), "Z -> c");
+    CHECK_EQ(cache.size(), 2u);
+    CHECK_EQ(cache.evictions(), 1u);
+
+    // the occurs-check policy is part of the key
+    unifier.setOccursCheck(OccursCheck::None);
+    CHECK_EQ(cached(cache, unifier, "k(Z)", "k(c)"), "Z -> c");
+    CHECK_EQ(cache.misses(), 4u);
+
+    cache.clear();
+    CHECK_EQ(cache.size(), 0u);
+    CHECK_EQ(cache.hits(), 0u);
+    CHECK_THROWS(UnifyCache(0), std::invalid_argument);
+}
+
+int main() {
+    testHitsRename();
+    return testSummary();
+}
@@ -0,0 +1,230 @@
+#ifndef TERM_DATABASE_H
+#define TERM_DATABASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// ------------------------------ TermDatabase ------------------------------
+// Store of compound facts indexed by functor/arity and by the principal symbol of the
+// first argument (constant value, or functor/arity of a compound first argument).
+// candidates() returns only facts that pass both checks, so a goal is unified against a
+// small slice of the database instead of every fact.
+class TermDatabase {
+public:
+    using FactId = std::size_t;
+
+    // One successful query result.
+    struct Match {
+        FactId fact;
+        Unifier::Substitution substitution;
+    };
+
+    class Matches;
+
+    TermDatabase() = default;
+    TermDatabase(const TermDatabase&) = delete;
+    TermDatabase& operator=(const TermDatabase&) = delete;
+    TermDatabase(TermDatabase&&) = default;
+    TermDatabase& operator=(TermDatabase&&) = default;
+
+    // Stores a fact and returns its ID; IDs count up from 0 in insertion order.
+    FactId add(std::unique_ptr<Compound<std::string>> fact);
+
+    const Compound<std::string>& fact(FactId id) const;
+    std::size_t size() const noexcept;
+
+    // IDs of facts that may unify with goal, in insertion order. A variable goal yields
+    // every fact; a constant goal yields none, since every fact is a compound.
+    std::vector<FactId> candidates(const Term<std::string>& goal) const;
+
+    // Unifies goal with each candidate and returns the successes in insertion order.
+    std::vector<Match> query(const Term<std::string>& goal, Unifier& unifier) const;
+
+    // Lazy query(): each step unifies candidates only until the next success, and the
+    // candidates are read from the index in place, so taking the first k matches costs
+    // neither the remaining unifications nor a candidate list. goal and unifier must
+    // outlive the result, and add() invalidates it.
+    Matches matches(const Term<std::string>& goal, Unifier& unifier) const;
+
+private:
+    using Key = std::uint64_t;
+
+    // Candidate IDs of one goal in insertion order without copying them: every fact, or
+    // the merge of up to two sorted index lists.
+    struct Cursor {
+        const std::vector<FactId>* first = nullptr;
+        const std::vector<FactId>* second = nullptr;
+        std::size_t firstPos = 0;
+        std::size_t secondPos = 0;
+        FactId every = 0;  // with both lists null: IDs every .. everyEnd are left
+        FactId everyEnd = 0;
+
+        // Takes the next ID; false once none are left.
+        bool next(FactId& id) noexcept;
+    };
+
+    // Facts sharing one functor/arity.
+    struct Bucket {
+        std::vector<FactId> all;
+        std::vector<FactId> variableFirst;  // first argument is a variable: matches any key
+        std::unordered_map<Key, std::vector<FactId>> byFirst;
+    };
+
+    std::vector<std::unique_ptr<Compound<std::string>>> facts_;
+    std::unordered_map<Key, Bucket> buckets_;
+
+    static Key makeKey(TermKind kind, SymbolId symbol, std::size_t arity) noexcept;
+
+    // Index key of a constant or compound from its symbol ID; never interns anything.
+    static Key keyOf(const Term<std::string>& term) noexcept;
+
+    Cursor cursor(const Term<std::string>& goal) const;
+};
+
+// ------------------------- TermDatabase::Matches --------------------------
+// Single-pass sequence of the matches of one goal, produced on demand.
+//     for (TermDatabase::Match& m : db.matches(goal, unifier)) { ... break; }
+class TermDatabase::Matches {
+public:
+    class iterator {
+    public:
+        using value_type = Match;
+        using reference = Match&;
+        using pointer = Match*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+
+        Match& operator*() const noexcept;
+        Match* operator->() const noexcept;
+        iterator& operator++();
+        bool operator==(const iterator& other) const noexcept;
+        bool operator!=(const iterator& other) const noexcept;
+
+    private:
+        friend class Matches;
+
+        explicit iterator(Matches* owner) noexcept;
+
+        Matches* owner_;  // nullptr at the end
+    };
+
+    // Next match, or std::nullopt once the candidates are used up.
+    std::optional<Match> next();
+
+    // Iteration over the matches not taken yet; begin() computes the first of them.
+    iterator begin();
+    iterator end() noexcept;
+
+private:
+    friend class TermDatabase;
+
+    Matches(const TermDatabase& db, const Term<std::string>& goal, Unifier& unifier,
+            Cursor cursor) noexcept;
+
+    const TermDatabase* db_;
+    const Term<std::string>* goal_;
+    Unifier* unifier_;
+    Cursor cursor_;
+    std::optional<Match> current_;  // the match an iterator points at
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline const Compound<std::string>& TermDatabase::fact(FactId id) const {
+    return *facts_.at(id);
+}
+
+inline std::size_t TermDatabase::size() const noexcept {
+    return facts_.size();
+}
+
+inline TermDatabase::Key TermDatabase::makeKey(TermKind kind, SymbolId symbol,
+                                               std::size_t arity) noexcept {
+    return (static_cast<Key>(symbol) << 32) | (static_cast<Key>(arity & 0x3fffffffu) << 2) |
+           static_cast<Key>(kind);
+}
+
+inline TermDatabase::Key TermDatabase::keyOf(const Term<std::string>& term) noexcept {
+    if (term.isConstant()) {
+        return makeKey(TermKind::Constant, termCast<Constant>(term).id(), 0);
+    }
+    const auto& comp = termCast<Compound<std::string>>(term);
+    return makeKey(TermKind::Compound, comp.functorId(), comp.arity());
+}
+
+inline bool TermDatabase::Cursor::next(FactId& id) noexcept {
+    if (first == nullptr) {
+        if (every == everyEnd) {
+            return false;
+        }
+        id = every++;
+        return true;
+    }
+    const bool firstLeft = firstPos < first->size();
+    const bool secondLeft = second != nullptr && secondPos < second->size();
+    if (firstLeft && (!secondLeft || (*first)[firstPos] < (*second)[secondPos])) {
+        id = (*first)[firstPos++];
+        return true;
+    }
+    if (secondLeft) {
+        id = (*second)[secondPos++];
+        return true;
+    }
+    return false;
+}
+
+inline TermDatabase::Matches TermDatabase::matches(const Term<std::string>& goal,
+                                                   Unifier& unifier) const {
+    return Matches(*this, goal, unifier, cursor(goal));
+}
+
+inline TermDatabase::Matches::Matches(const TermDatabase& db, const Term<std::string>& goal,
+                                      Unifier& unifier, Cursor cursor) noexcept
+    : db_(&db), goal_(&goal), unifier_(&unifier), cursor_(cursor) {}
+
+inline TermDatabase::Matches::iterator TermDatabase::Matches::begin() {
+    current_ = next();
+    return iterator(current_ ? this : nullptr);
+}
+
+inline TermDatabase::Matches::iterator TermDatabase::Matches::end() noexcept {
+    return iterator(nullptr);
+}
+
+inline TermDatabase::Matches::iterator::iterator(Matches* owner) noexcept : owner_(owner) {}
+
+inline TermDatabase::Match& TermDatabase::Matches::iterator::operator*() const noexcept {
+    return *owner_->current_;
+}
+
+inline TermDatabase::Match* TermDatabase::Matches::iterator::operator->() const noexcept {
+    return &*owner_->current_;
+}
+
+inline TermDatabase::Matches::iterator& TermDatabase::Matches::iterator::operator++() {
+    owner_->current_ = owner_->next();
+    if (!owner_->current_) {
+        owner_ = nullptr;
+    }
+    return *this;
+}
+
+inline bool TermDatabase::Matches::iterator::operator==(const iterator& other) const noexcept {
+    return owner_ == other.owner_;
+}
+
+inline bool TermDatabase::Matches::iterator::operator!=(const iterator& other) const noexcept {
+    return owner_ != other.owner_;
+}
+
+#endif // TERM_DATABASE_H
@@ -0,0 +1,88 @@
+#include "term_database.h"
+
+#include <stdexcept>
+
+TermDatabase::FactId TermDatabase::add(std::unique_ptr<Compound<std::string>> fact) {
+    if (fact == nullptr) {
+        throw std::invalid_argument("TermDatabase::add given a null fact");
+    }
+    const FactId id = facts_.size();
+    Bucket& bucket = buckets_[keyOf(*fact)];
+    bucket.all.push_back(id);
+    if (fact->arity() > 0) {
+        const Term<std::string>& first = fact->arg(0);
+        if (first.isVariable()) {
+            bucket.variableFirst.push_back(id);
+        } else {
+            bucket.byFirst[keyOf(first)].push_back(id);
+        }
+    }
+    facts_.push_back(std::move(fact));
+    return id;
+}
+
+std::vector<TermDatabase::FactId> TermDatabase::candidates(const Term<std::string>& goal) const {
+    Cursor ids = cursor(goal);
+    if (ids.first != nullptr && ids.second == nullptr) {
+        return *ids.first;
+    }
+    std::vector<FactId> out;
+    out.reserve(ids.first == nullptr ? ids.everyEnd
+                                     : ids.first->size() + ids.second->size());
+    for (FactId id; ids.next(id);) {
+        out.push_back(id);
+    }
+    return out;
+}
+
+TermDatabase::Cursor TermDatabase::cursor(const Term<std::string>& goal) const {
+    Cursor ids;
+    if (goal.isVariable()) {
+        ids.everyEnd = facts_.size();
+        return ids;
+    }
+    if (!goal.isCompound()) {
+        return ids;
+    }
+
+    auto bucketIt = buckets_.find(keyOf(goal));
+    if (bucketIt == buckets_.end()) {
+        return ids;
+    }
+    const Bucket& bucket = bucketIt->second;
+
+    const auto& comp = termCast<Compound<std::string>>(goal);
+    if (comp.arity() == 0 || comp.arg(0).isVariable()) {
+        ids.first = &bucket.all;
+        return ids;
+    }
+
+    // facts keyed on the same first symbol, plus those with a variable first argument
+    ids.first = &bucket.variableFirst;
+    auto keyedIt = bucket.byFirst.find(keyOf(comp.arg(0)));
+    if (keyedIt != bucket.byFirst.end()) {
+        ids.second = &keyedIt->second;
+    }
+    return ids;
+}
+
+std::vector<TermDatabase::Match> TermDatabase::query(const Term<std::string>& goal,
+                                                     Unifier& unifier) const {
+    std::vector<Match> out;
+    Matches found = matches(goal, unifier);
+    while (auto match = found.next()) {
+        out.push_back(std::move(*match));
+    }
+    return out;
+}
+
+// ------------------------- TermDatabase::Matches --------------------------
+
+std::optional<TermDatabase::Match> TermDatabase::Matches::next() {
+    for (FactId id; cursor_.next(id);) {
+        if (auto sub = unifier_->unify(*goal_, *db_->facts_[id])) {
+            return Match{id, std::move(*sub)};
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,79 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "term_database.h"
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Adds every clause of text to db as a fact.
+void load(TermDatabase& db, const std::string& text) {
+    for (TermPtr& clause : parseClauses(text)) {
+        db.add(std::unique_ptr<Compound<std::string>>(
+            static_cast<Compound<std::string>*>(clause.release())));
+    }
+}
+
+std::vector<TermDatabase::FactId> candidates(const TermDatabase& db, const std::string& goal) {
+    return db.candidates(*parseTerm(goal));
+}
+
+using Ids = std::vector<TermDatabase::FactId>;
+
+// Only facts with the goal's functor/arity and a compatible first argument are tried,
+// in insertion order.
+void testCandidates() {
+    TermDatabase db;
+    load(db,
+         "p(a, 1). p(b, 2). p(X, 3). p(f(a), 4). p(f(b, c), 5). p(a, 6). q(a, 7). p(a).");
+    CHECK_EQ(db.size(), 8u);
+    CHECK(candidates(db, "p(a, N)") == (Ids{0, 2, 5}));
+    CHECK(candidates(db, "p(b, N)") == (Ids{1, 2}));
+    CHECK(candidates(db, "p(c, N)") == (Ids{2}));
+    CHECK(candidates(db, "p(f(Z), N)") == (Ids{2, 3}));
+    CHECK(candidates(db, "p(f(Z, W), N)") == (Ids{2, 4}));
+    CHECK(candidates(db, "p(Y, N)") == (Ids{0, 1, 2, 3, 4, 5}));
+    CHECK(candidates(db, "q(Y, N)") == (Ids{6}));
+    CHECK(candidates(db, "p(Y)") == (Ids{7}));
+    CHECK(candidates(db, "r(a)").empty());
+    CHECK(candidates(db, "Any") == (Ids{0, 1, 2, 3, 4, 5, 6, 7}));
+    CHECK(candidates(db, "a").empty());
+}
+
+void testQuery() {
+    TermDatabase db;
+    load(db, "edge(a, b). edge(a, c). edge(b, c). edge(X, X).");
+    Unifier unifier;
+    TermPtr goal = parseTerm("edge(a, W)");
+    std::vector<TermDatabase::Match> all = db.query(*goal, unifier);
+    CHECK_EQ(all.size(), 3u);
+    if (all.size() == 3) {
+        CHECK_EQ(all[0].fact, 0u);
+        CHECK_EQ(formatSubstitution(all[1].substitution), "W -> c");
+        CHECK_EQ(all[2].fact, 3u);
+        CHECK_EQ(formatSubstitution(all[2].substitution), "W -> a, X -> a");
+    }
+
+    // taking the first match leaves the rest unread
+    TermDatabase::Matches lazy = db.matches(*goal, unifier);
+    auto first = lazy.next();
+    CHECK(first.has_value() && first->fact == 0u);
+    std::size_t rest = 0;
+    for (TermDatabase::Match& match : lazy) {
+        CHECK(match.fact > 0u);
+        ++rest;
+    }
+    CHECK_EQ(rest, 2u);
+    CHECK(!lazy.next().has_value());
+    CHECK_EQ(formatTerm(db.fact(2)), "edge(b, c)");
+}
+
+int main() {
+    testCandidates();
+    testQuery();
+    return testSummary();
+}
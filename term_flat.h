@@ -0,0 +1,133 @@
+#ifndef TERM_FLAT_H
+#define TERM_FLAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "term_memory.h"
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// Index of a cell inside a FlatHeap.
+using CellIndex = std::uint32_t;
+
+// ------------------------------- FlatHeap ---------------------------------
+// WAM-style contiguous term encoding: every term lives in one std::vector of 8-byte
+// tagged cells, and unification walks it iteratively with an explicit work list.
+//   Ref  value = referenced cell (itself when the variable is unbound)
+//   Str  value = index of the structure's Fun header
+//   Fun  value = functor symbol, arity stored in the header; arguments follow in place
+//   Con  value = constant symbol
+// Variables are shared by name across all terms in the heap, matching Unifier semantics.
+// Bindings stay in the cells until reset(), so a batch can encode terms once and then
+// unify/reset them many times without allocating.
+class FlatHeap {
+public:
+    enum class Tag : std::uint8_t { Ref, Str, Fun, Con };
+
+    class Cell {
+    private:
+        std::uint32_t header_;  // tag in the low 2 bits, arity above
+        std::uint32_t value_;
+
+    public:
+        Cell(Tag tag, std::uint32_t value, std::uint32_t arity = 0) noexcept;
+
+        Tag tag() const noexcept;
+        std::uint32_t value() const noexcept;
+        std::uint32_t arity() const noexcept;
+    };
+
+    FlatHeap() = default;
+    FlatHeap(const FlatHeap&) = delete;
+    FlatHeap& operator=(const FlatHeap&) = delete;
+
+    // Appends a term and returns the index of its root cell.
+    CellIndex encode(const Term<std::string>& term);
+
+    // Rebuilds a pointer-based term from a root cell with current bindings applied.
+    std::unique_ptr<Term<std::string>> decode(CellIndex root) const;
+
+    // Unifies two encoded terms. Bindings are kept until reset(); on failure the
+    // partial bindings are kept too, so callers should reset() before reusing the heap.
+    bool unify(CellIndex a, CellIndex b);
+
+    // Undoes every binding made since the last reset().
+    void reset();
+
+    // Current bindings, copied out in the same form Unifier::unify returns.
+    Unifier::Substitution substitution() const;
+
+    const Cell& cell(CellIndex index) const;
+    std::size_t size() const noexcept;
+    const SymbolTable& symbols() const noexcept;
+
+    // Bytes held by the heap, by kind: every cell is 8 bytes, Ref cells count as
+    // variables and Fun headers with their Str pointers as compounds.
+    MemoryFootprint memoryFootprint() const;
+
+private:
+    std::vector<Cell> cells_;
+    SymbolTable symbols_;
+    std::unordered_map<SymbolId, CellIndex> varCells_;
+    std::unordered_map<CellIndex, SymbolId> varNames_;
+    std::vector<CellIndex> trail_;
+    std::vector<std::pair<CellIndex, CellIndex>> pdl_;  // reusable unification work list
+    std::vector<CellIndex> scan_;                       // reusable occurs-check work list
+    // reusable encode work list: a term and the argument slot its cell goes to
+    std::vector<std::pair<const Term<std::string>*, CellIndex>> encodeTasks_;
+    mutable TermCloner<CellIndex> cloner_;  // reusable decode stacks
+
+    static constexpr CellIndex kRootSlot = static_cast<CellIndex>(-1);
+
+    // Cell for term; a compound's header and argument slots are appended and one
+    // encodeTasks_ entry is queued per argument.
+    Cell encodeCell(const Term<std::string>& term);
+    CellIndex deref(CellIndex index) const;
+    bool occurs(CellIndex var, CellIndex index);
+    void bind(CellIndex var, CellIndex target);
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline FlatHeap::Cell::Cell(Tag tag, std::uint32_t value, std::uint32_t arity) noexcept
+    : header_(static_cast<std::uint32_t>(tag) | (arity << 2)), value_(value) {}
+
+inline FlatHeap::Tag FlatHeap::Cell::tag() const noexcept {
+    return static_cast<Tag>(header_ & 3u);
+}
+
+inline std::uint32_t FlatHeap::Cell::value() const noexcept {
+    return value_;
+}
+
+inline std::uint32_t FlatHeap::Cell::arity() const noexcept {
+    return header_ >> 2;
+}
+
+inline const FlatHeap::Cell& FlatHeap::cell(CellIndex index) const {
+    return cells_.at(index);
+}
+
+inline std::size_t FlatHeap::size() const noexcept {
+    return cells_.size();
+}
+
+inline const SymbolTable& FlatHeap::symbols() const noexcept {
+    return symbols_;
+}
+
+inline CellIndex FlatHeap::deref(CellIndex index) const {
+    while (cells_[index].tag() == Tag::Ref && cells_[index].value() != index) {
+        index = cells_[index].value();
+    }
+    return index;
+}
+
+#endif // TERM_FLAT_H
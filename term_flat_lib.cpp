@@ -0,0 +1,230 @@
+#include "term_flat.h"
+
+#include <algorithm>
+
+#include "term_simd.h"
+
+CellIndex FlatHeap::encode(const Term<std::string>& term) {
+    // cells are laid out depth-first, leftmost argument first; the root cell goes last
+    Cell root(Tag::Con, 0);
+    encodeTasks_.clear();
+    encodeTasks_.emplace_back(&term, kRootSlot);
+    while (!encodeTasks_.empty()) {
+        const auto [current, slot] = encodeTasks_.back();
+        encodeTasks_.pop_back();
+        const Cell cell = encodeCell(*current);
+        if (slot == kRootSlot) {
+            root = cell;
+        } else {
+            cells_[slot] = cell;
+        }
+    }
+    cells_.push_back(root);
+    return static_cast<CellIndex>(cells_.size() - 1);
+}
+
+std::unique_ptr<Term<std::string>> FlatHeap::decode(CellIndex root) const {
+    return cloner_.build(root, [this](CellIndex index, auto& step) {
+        index = deref(index);
+        const Cell c = cells_[index];
+        switch (c.tag()) {
+        case Tag::Ref:
+            step.leaf(std::make_unique<Variable>(symbols_.name(varNames_.at(index))));
+            return;
+        case Tag::Con:
+            step.leaf(std::make_unique<Constant>(symbols_.name(c.value())));
+            return;
+        case Tag::Fun:
+        case Tag::Str:
+            break;
+        }
+        const CellIndex header = c.tag() == Tag::Str ? c.value() : index;
+        const Cell functor = cells_[header];
+        step.compound(symbols_.name(functor.value()), functor.arity());
+        for (std::uint32_t i = 1; i <= functor.arity(); ++i) {
+            step.child(header + i);
+        }
+    });
+}
+
+bool FlatHeap::unify(CellIndex a, CellIndex b) {
+    pdl_.clear();
+    pdl_.emplace_back(a, b);
+    while (!pdl_.empty()) {
+        const CellIndex x = deref(pdl_.back().first);
+        const CellIndex y = deref(pdl_.back().second);
+        pdl_.pop_back();
+        if (x == y) {
+            continue;
+        }
+
+        const Cell cx = cells_[x];
+        const Cell cy = cells_[y];
+        const bool xIsVar = cx.tag() == Tag::Ref;
+        const bool yIsVar = cy.tag() == Tag::Ref;
+
+        // same rule as Unifier: bind the lexicographically smaller variable to the other
+        if (xIsVar && yIsVar) {
+            if (symbols_.name(varNames_.at(x)) < symbols_.name(varNames_.at(y))) {
+                bind(x, y);
+            } else {
+                bind(y, x);
+            }
+            continue;
+        }
+        if (xIsVar) {
+            if (occurs(x, y)) {
+                return false;
+            }
+            bind(x, y);
+            continue;
+        }
+        if (yIsVar) {
+            if (occurs(y, x)) {
+                return false;
+            }
+            bind(y, x);
+            continue;
+        }
+
+        if (cx.tag() != cy.tag()) {
+            return false;
+        }
+        if (cx.tag() == Tag::Con) {
+            if (cx.value() != cy.value()) {
+                return false;
+            }
+            continue;
+        }
+
+        // both Str: compare headers, then queue argument pairs left to right
+        const CellIndex hx = cx.value();
+        const CellIndex hy = cy.value();
+        if (hx == hy) {
+            continue;
+        }
+        const Cell fx = cells_[hx];
+        const Cell fy = cells_[hy];
+        if (fx.value() != fy.value() || fx.arity() != fy.arity()) {
+            return false;
+        }
+        // bitwise-equal argument cells (same constant, structure or variable) unify as
+        // they are, so only the differing ones are queued, leftmost on top
+        static_assert(sizeof(Cell) == 8, "argument cells are compared as bytes");
+        const std::size_t arity = fx.arity();
+        const std::size_t queued = pdl_.size();
+        for (std::size_t i = 0; i < arity; ++i) {
+            i += BulkCompare::firstMismatchByte(&cells_[hx + 1 + i], &cells_[hy + 1 + i],
+                                                (arity - i) * sizeof(Cell)) /
+                 sizeof(Cell);
+            if (i == arity) {
+                break;
+            }
+            pdl_.emplace_back(hx + 1 + i, hy + 1 + i);
+        }
+        std::reverse(pdl_.begin() + queued, pdl_.end());
+    }
+    return true;
+}
+
+void FlatHeap::reset() {
+    for (CellIndex var : trail_) {
+        cells_[var] = Cell(Tag::Ref, var);
+    }
+    trail_.clear();
+}
+
+Unifier::Substitution FlatHeap::substitution() const {
+    Unifier::Substitution out;
+    for (CellIndex var : trail_) {
+        out[symbols_.name(varNames_.at(var))] = decode(cells_[var].value());
+    }
+    return out;
+}
+
+FlatHeap::Cell FlatHeap::encodeCell(const Term<std::string>& term) {
+    if (term.isVariable()) {
+        const SymbolId name = symbols_.intern(termCast<Variable>(term).name());
+        auto it = varCells_.find(name);
+        if (it == varCells_.end()) {
+            const auto index = static_cast<CellIndex>(cells_.size());
+            cells_.emplace_back(Tag::Ref, index);
+            it = varCells_.emplace(name, index).first;
+            varNames_.emplace(index, name);
+        }
+        return Cell(Tag::Ref, it->second);
+    }
+
+    if (term.isConstant()) {
+        return Cell(Tag::Con, symbols_.intern(termCast<Constant>(term).value()));
+    }
+
+    const auto& comp = termCast<Compound<std::string>>(term);
+    const auto header = static_cast<CellIndex>(cells_.size());
+    const auto arity = static_cast<std::uint32_t>(comp.arity());
+    cells_.emplace_back(Tag::Fun, symbols_.intern(comp.functor()), arity);
+    // reserve the argument slots first so they stay contiguous behind the header; each
+    // is filled when its task comes up, leftmost first
+    cells_.resize(cells_.size() + arity, Cell(Tag::Con, 0));
+    for (std::uint32_t i = arity; i > 0; --i) {
+        encodeTasks_.emplace_back(&comp.arg(i - 1), header + i);
+    }
+    return Cell(Tag::Str, header);
+}
+
+bool FlatHeap::occurs(CellIndex var, CellIndex index) {
+    scan_.clear();
+    scan_.push_back(index);
+    while (!scan_.empty()) {
+        const CellIndex current = deref(scan_.back());
+        scan_.pop_back();
+        if (current == var) {
+            return true;
+        }
+        if (cells_[current].tag() != Tag::Str) {
+            continue;
+        }
+        const CellIndex header = cells_[current].value();
+        for (std::uint32_t i = 1; i <= cells_[header].arity(); ++i) {
+            scan_.push_back(header + i);
+        }
+    }
+    return false;
+}
+
+void FlatHeap::bind(CellIndex var, CellIndex target) {
+    cells_[var] = Cell(Tag::Ref, target);
+    trail_.push_back(var);
+}
+
+MemoryFootprint FlatHeap::memoryFootprint() const {
+    MemoryFootprint out;
+    for (const Cell& cell : cells_) {
+        switch (cell.tag()) {
+        case Tag::Ref:
+            ++out.variables.count;
+            out.variables.bytes += sizeof(Cell);
+            break;
+        case Tag::Con:
+            ++out.constants.count;
+            out.constants.bytes += sizeof(Cell);
+            break;
+        case Tag::Fun:
+            ++out.compounds.count;
+            out.compounds.bytes += sizeof(Cell);
+            break;
+        case Tag::Str:
+            out.compounds.bytes += sizeof(Cell);
+            break;
+        }
+    }
+    out.symbols = symbols_.memoryUsage();
+    out.overhead =
+        (cells_.capacity() - cells_.size()) * sizeof(Cell) +
+        (varCells_.bucket_count() + varNames_.bucket_count()) * sizeof(void*) +
+        varCells_.size() * MemoryFootprint::hashEntryBytes(sizeof(*varCells_.begin())) +
+        varNames_.size() * MemoryFootprint::hashEntryBytes(sizeof(*varNames_.begin())) +
+        trail_.capacity() * sizeof(CellIndex) + pdl_.capacity() * sizeof(pdl_[0]) +
+        scan_.capacity() * sizeof(CellIndex) + encodeTasks_.capacity() * sizeof(encodeTasks_[0]);
+    return out;
+}
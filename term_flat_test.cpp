@@ -0,0 +1,80 @@
+#include <memory>
+#include <string>
+
+#include "term_flat.h"
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// cons(a, cons(a, ... tail)) with length cells.
+TermPtr list(std::size_t length, TermPtr tail) {
+    for (std::size_t i = 0; i < length; ++i) {
+        tail = builders::compound("cons", builders::constant("a"), std::move(tail));
+    }
+    return tail;
+}
+
+void testEncodeDecode() {
+    FlatHeap heap;
+    TermPtr term = parseTerm("f(X, g(a, Y), X, h)");
+    const CellIndex root = heap.encode(*term);
+    CHECK_EQ(formatTerm(*heap.decode(root)), "f(X, g(a, Y), X, h)");
+    CHECK(heap.cell(root).tag() == FlatHeap::Tag::Str);
+    const CellIndex header = heap.cell(root).value();
+    CHECK(heap.cell(header).tag() == FlatHeap::Tag::Fun);
+    CHECK_EQ(heap.cell(header).arity(), 4u);
+    // both X arguments reference the one variable cell
+    CHECK_EQ(heap.cell(header + 1).value(), heap.cell(header + 3).value());
+}
+
+void testUnifyReset() {
+    FlatHeap heap;
+    TermPtr lhs = parseTerm("p(X, f(Y), Y)");
+    TermPtr rhs = parseTerm("p(f(a), X, Z)");
+    const CellIndex a = heap.encode(*lhs);
+    const CellIndex b = heap.encode(*rhs);
+    CHECK(heap.unify(a, b));
+    CHECK_EQ(formatSubstitution(heap.substitution()), "X -> f(a), Y -> a, Z -> a");
+    CHECK_EQ(formatTerm(*heap.decode(a)), "p(f(a), f(a), a)");
+
+    heap.reset();
+    CHECK(heap.substitution().empty());
+    CHECK_EQ(formatTerm(*heap.decode(a)), "p(X, f(Y), Y)");
+
+    TermPtr cyclic = parseTerm("f(X)");
+    TermPtr var = parseTerm("X");
+    CHECK(!heap.unify(heap.encode(*var), heap.encode(*cyclic)));
+    heap.reset();
+    TermPtr other = parseTerm("p(a, b, c)");
+    CHECK(!heap.unify(a, heap.encode(*other)));
+}
+
+// Encoding, decoding and unifying a 100k-cell list use no recursion.
+void testDeepList() {
+    constexpr std::size_t kLength = 100000;
+    FlatHeap heap;
+    TermPtr closed = list(kLength, builders::constant("nil"));
+    TermPtr open = list(kLength, builders::var("T"));
+    const CellIndex c = heap.encode(*closed);
+    const CellIndex o = heap.encode(*open);
+
+    TermPtr decoded = heap.decode(c);
+    Unifier unifier;
+    CHECK(unifier.unify(*decoded, *closed).has_value());
+
+    CHECK(heap.unify(o, c));
+    CHECK_EQ(formatSubstitution(heap.substitution()), "T -> nil");
+    heap.reset();
+    TermPtr tail = builders::var("T");
+    CHECK(!heap.unify(heap.encode(*tail), o));
+}
+
+int main() {
+    testEncodeDecode();
+    testUnifyReset();
+    testDeepList();
+    return testSummary();
+}
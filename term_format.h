@@ -0,0 +1,79 @@
+#ifndef TERM_FORMAT_H
+#define TERM_FORMAT_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "term_unification.h"
+
+// How atom names are written.
+//   Plain      names as stored, e.g. f(hello world)
+//   Parseable  constants and functors that would not read back as the same atom are
+//              quoted and escaped, e.g. f('hello world'), so TermParser returns the
+//              same term. Variable names are always written as stored.
+enum class Quoting { Plain, Parseable };
+
+// ------------------------------ TermFormatter -----------------------------
+// Renders terms and substitutions as text (f(X, g(a)), X -> a, Y -> b) without
+// recursion: nesting is tracked on a stack that is reused across calls, and text is
+// appended straight to a std::string, so a caller that keeps both the formatter and its
+// output buffer formats without allocating once they have grown. Not thread-safe.
+class TermFormatter {
+public:
+    explicit TermFormatter(Quoting quoting = Quoting::Plain) noexcept;
+
+    // Appends the text of term (or of the bindings of sub, in map order) to out.
+    void append(std::string& out, const Term<std::string>& term);
+    void append(std::string& out, const Unifier::Substitution& sub);
+
+    // Same, into a buffer owned by the formatter; the view stays valid until the next
+    // call to format().
+    std::string_view format(const Term<std::string>& term);
+    std::string_view format(const Unifier::Substitution& sub);
+
+    Quoting quoting() const noexcept;
+
+private:
+    // Compound whose arguments are being written; next is the next argument's index.
+    struct Frame {
+        const Compound<std::string>* compound;
+        std::size_t next;
+    };
+
+    Quoting quoting_;
+    std::vector<Frame> frames_;
+    std::string buffer_;
+
+    void appendAtom(std::string& out, std::string_view name) const;
+};
+
+// -------------------------------- Helpers ---------------------------------
+
+// One-off formatting into a new string.
+std::string formatTerm(const Term<std::string>& term, Quoting quoting = Quoting::Plain);
+std::string formatSubstitution(const Unifier::Substitution& sub,
+                               Quoting quoting = Quoting::Plain);
+
+// ------------------------- Inline Implementations ------------------------
+
+inline TermFormatter::TermFormatter(Quoting quoting) noexcept : quoting_(quoting) {}
+
+inline Quoting TermFormatter::quoting() const noexcept {
+    return quoting_;
+}
+
+inline std::string_view TermFormatter::format(const Term<std::string>& term) {
+    buffer_.clear();
+    append(buffer_, term);
+    return buffer_;
+}
+
+inline std::string_view TermFormatter::format(const Unifier::Substitution& sub) {
+    buffer_.clear();
+    append(buffer_, sub);
+    return buffer_;
+}
+
+#endif // TERM_FORMAT_H
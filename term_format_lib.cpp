@@ -0,0 +1,120 @@
+#include "term_format.h"
+
+namespace {
+
+bool isNameChar(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_';
+}
+
+// True when name reads back as the same atom without quotes (see term_parser.h).
+bool isBareAtom(std::string_view name) noexcept {
+    if (name.empty()) {
+        return false;
+    }
+    const char first = name[0];
+    if (!((first >= 'a' && first <= 'z') || (first >= '0' && first <= '9'))) {
+        return false;
+    }
+    for (char c : name) {
+        if (!isNameChar(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+void TermFormatter::append(std::string& out, const Term<std::string>& term) {
+    // leaves are written on sight; a compound writes "f(" and is then resumed once per
+    // argument, writing ", " between arguments and ")" after the last
+    const Term<std::string>* current = &term;
+    frames_.clear();
+    for (;;) {
+        if (current != nullptr) {
+            switch (current->kind()) {
+            case TermKind::Variable:
+                out += termCast<Variable>(*current).name();
+                break;
+            case TermKind::Constant:
+                appendAtom(out, termCast<Constant>(*current).value());
+                break;
+            case TermKind::Compound: {
+                const auto& comp = termCast<Compound<std::string>>(*current);
+                appendAtom(out, comp.functor());
+                out += '(';
+                frames_.push_back(Frame{&comp, 0});
+                break;
+            }
+            }
+            current = nullptr;
+        }
+
+        if (frames_.empty()) {
+            return;
+        }
+        Frame& frame = frames_.back();
+        if (frame.next == frame.compound->arity()) {
+            out += ')';
+            frames_.pop_back();
+            continue;
+        }
+        if (frame.next > 0) {
+            out += ", ";
+        }
+        current = &frame.compound->arg(frame.next++);
+    }
+}
+
+void TermFormatter::append(std::string& out, const Unifier::Substitution& sub) {
+    bool first = true;
+    for (const auto& [name, value] : sub) {
+        if (!first) {
+            out += ", ";
+        }
+        out += name;
+        out += " -> ";
+        append(out, *value);
+        first = false;
+    }
+}
+
+void TermFormatter::appendAtom(std::string& out, std::string_view name) const {
+    if (quoting_ == Quoting::Plain || isBareAtom(name)) {
+        out += name;
+        return;
+    }
+    out += '\'';
+    for (char c : name) {
+        switch (c) {
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\'':
+            out += "\\'";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        default:
+            out += c;
+            break;
+        }
+    }
+    out += '\'';
+}
+
+// -------------------------------- Helpers ---------------------------------
+
+std::string formatTerm(const Term<std::string>& term, Quoting quoting) {
+    std::string out;
+    TermFormatter(quoting).append(out, term);
+    return out;
+}
+
+std::string formatSubstitution(const Unifier::Substitution& sub, Quoting quoting) {
+    std::string out;
+    TermFormatter(quoting).append(out, sub);
+    return out;
+}
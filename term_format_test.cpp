@@ -0,0 +1,111 @@
+#include <memory>
+#include <string>
+
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Value of a parsed constant, or of the functor of a parsed compound.
+std::string atomOf(const std::string& text) {
+    TermPtr term = parseTerm(text);
+    if (term->isCompound()) {
+        return termCast<Compound<std::string>>(*term).functor();
+    }
+    return termCast<Constant>(*term).value();
+}
+
+// Nesting is limited by memory, not by the call stack.
+void testDeep() {
+    const std::size_t depth = 100000;
+    std::string text;
+    for (std::size_t i = 0; i < depth; ++i) {
+        text += "s(";
+    }
+    text += "X";
+    text.append(depth, ')');
+    TermPtr term = parseTerm(text);
+    CHECK(formatTerm(*term) == text);
+    CHECK(formatTerm(*term, Quoting::Parseable) == text);
+
+    TermFormatter formatter;
+    CHECK(formatter.format(*term) == text);
+    CHECK(formatter.format(*term) == text);  // the frame stack is emptied after each call
+}
+
+// Backslashes, quotes and newlines are escaped, and the result reads back unchanged.
+void testEscaping() {
+    const std::string awkward = "a\\b'c\nd";
+    TermPtr constant = builders::constant(awkward);
+    const std::string quoted = formatTerm(*constant, Quoting::Parseable);
+    CHECK_EQ(quoted, "'a\\\\b\\'c\\nd'");
+    CHECK_EQ(atomOf(quoted), awkward);
+    CHECK_EQ(formatTerm(*constant), awkward);  // Plain writes the name as stored
+
+    TermPtr term = builders::compound("it's", builders::constant("\\"), builders::var("X"));
+    const std::string text = formatTerm(*term, Quoting::Parseable);
+    CHECK_EQ(text, "'it\\'s'('\\\\', X)");
+    CHECK_EQ(atomOf(text), "it's");
+    CHECK_EQ(formatTerm(*parseTerm(text), Quoting::Parseable), text);
+}
+
+// Atoms that would not read back as the same atom bare are quoted; the rest are not.
+void testQuoting() {
+    const auto parseable = [](const std::string& name) {
+        return formatTerm(*builders::constant(name), Quoting::Parseable);
+    };
+    CHECK_EQ(parseable(""), "''");
+    CHECK_EQ(parseable("Abc"), "'Abc'");
+    CHECK_EQ(parseable("_x"), "'_x'");
+    CHECK_EQ(parseable("hello world"), "'hello world'");
+    CHECK_EQ(parseable("abc"), "abc");
+    CHECK_EQ(parseable("a_B1"), "a_B1");
+    CHECK_EQ(parseable("42"), "42");
+    for (const std::string name : {"", "Abc", "_x", "hello world"}) {
+        CHECK_EQ(atomOf(parseable(name)), name);
+    }
+
+    CHECK_EQ(formatTerm(*builders::compound("Big", builders::constant(""))), "Big()");
+    CHECK_EQ(formatTerm(*builders::compound("Big", builders::constant("")), Quoting::Parseable),
+             "'Big'('')");
+}
+
+// A formatter keeps its buffer across format() calls, and append() leaves the caller's
+// buffer in the caller's hands.
+void testBufferReuse() {
+    TermPtr large = parseTerm("f(g(a, b, c), h(X, Y, Z), k(long_constant_name))");
+    TermPtr small = parseTerm("p(a)");
+    TermFormatter formatter;
+    const std::string_view first = formatter.format(*large);
+    CHECK_EQ(std::string(first), formatTerm(*large));
+    const char* const data = first.data();
+    const std::string_view second = formatter.format(*small);
+    CHECK_EQ(std::string(second), "p(a)");
+    CHECK(second.data() == data);  // same storage, no regrowth
+
+    Unifier::Substitution sub;
+    sub.emplace("X", parseTerm("f(a)"));
+    sub.emplace("Y", parseTerm("b"));
+    CHECK_EQ(std::string(formatter.format(sub)), "X -> f(a), Y -> b");
+    CHECK(formatter.format(sub).data() == data);
+
+    std::string out = "head: ";
+    formatter.append(out, *small);
+    formatter.append(out, *small);
+    CHECK_EQ(out, "head: p(a)p(a)");
+    out.clear();
+    const std::size_t capacity = out.capacity();
+    formatter.append(out, *small);
+    CHECK_EQ(out, "p(a)");
+    CHECK_EQ(out.capacity(), capacity);
+}
+
+int main() {
+    testDeep();
+    testEscaping();
+    testQuoting();
+    testBufferReuse();
+    return testSummary();
+}
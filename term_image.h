@@ -0,0 +1,224 @@
+#ifndef TERM_IMAGE_H
+#define TERM_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "term_parser.h"
+#include "term_store.h"
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// Binary image of a TermStore: its symbol table and node array written out as-is, plus
+// a list of root terms and a list of substitutions. Node IDs, symbol IDs and
+// TermStore::Substitution keys keep their store values, and children always come
+// before their parents.
+//
+// Layout (native byte order, every section 8-byte aligned):
+//   Header                                    48 bytes, see TermImage::Header
+//   nodes          Cell[nodeCount]            16 bytes each
+//   args           TermId[argCount]
+//   terms          TermId[termCount]
+//   substitutions  uint32[substitutionCount + 1]  start of each in bindings
+//   bindings       Binding[bindingCount]      8 bytes each
+//   symbols        uint64[symbolCount + 1]    start of each name in text
+//   text           char[textBytes]            names back to back, no terminators
+// A process maps the file and reads terms and names straight out of the mapping, so
+// loading costs one validation pass and several processes share the same pages.
+
+// ----------------------------- TermImageWriter ----------------------------
+class TermImageWriter {
+public:
+    // store must outlive the writer; everything it holds is written.
+    explicit TermImageWriter(const TermStore& store) noexcept;
+
+    // Adds a root term (throws std::out_of_range for an ID not in the store).
+    void addTerm(TermId id);
+
+    // Adds a substitution over the store's symbols and nodes.
+    void addSubstitution(const TermStore::Substitution& sub);
+
+    // Writes the image; throws std::runtime_error if the stream fails.
+    void write(std::ostream& out) const;
+
+    // Writes the image to a file, replacing it; throws std::runtime_error on failure.
+    void save(const std::string& path) const;
+
+private:
+    const TermStore& store_;
+    std::vector<TermId> terms_;
+    std::vector<std::uint32_t> substitutions_{0};
+    std::vector<std::pair<SymbolId, TermId>> bindings_;
+};
+
+// -------------------------------- TermImage -------------------------------
+// Read-only view of an image, answering the same queries as TermStore without building
+// anything. The constructors check the whole image (bounds, child order, symbol range)
+// and throw std::runtime_error if it is malformed, so accessors can skip the checks.
+class TermImage {
+public:
+    using Kind = TermStore::Kind;
+
+    // Maps the file at path (std::system_error if it cannot be opened or mapped).
+    explicit TermImage(const std::string& path);
+
+    // Views an image already in memory; the bytes must outlive the TermImage and be
+    // 8-byte aligned.
+    TermImage(const char* data, std::size_t size);
+
+    TermImage(const TermImage&) = delete;
+    TermImage& operator=(const TermImage&) = delete;
+    TermImage(TermImage&&) noexcept = default;
+    TermImage& operator=(TermImage&&) noexcept = default;
+
+    Kind kind(TermId id) const noexcept;
+    SymbolId symbol(TermId id) const noexcept;
+
+    // Name of the variable, constant value or functor; views the image.
+    std::string_view name(TermId id) const noexcept;
+
+    std::size_t arity(TermId id) const noexcept;
+
+    // Access the i-th argument of a compound (throws std::out_of_range on bad index).
+    TermId arg(TermId id, std::size_t index) const;
+
+    bool isGround(TermId id) const noexcept;
+
+    // Number of nodes.
+    std::size_t size() const noexcept;
+
+    // Text of a symbol ID (undefined for IDs not in the image).
+    std::string_view symbolName(SymbolId id) const noexcept;
+    std::size_t symbolCount() const noexcept;
+
+    // Root terms in the order they were added (throws std::out_of_range on bad index).
+    std::size_t termCount() const noexcept;
+    TermId term(std::size_t index) const;
+
+    // Substitutions in the order they were added (throws std::out_of_range on bad index).
+    std::size_t substitutionCount() const noexcept;
+    TermStore::Substitution substitution(std::size_t index) const;
+
+    // Rebuilds a pointer-based deep copy of a node, optionally with sub applied (which
+    // must be acyclic, as unify results and the image's own substitutions are).
+    std::unique_ptr<Term<std::string>> toTerm(TermId id) const;
+    std::unique_ptr<Term<std::string>> toTerm(TermId id, const TermStore::Substitution& sub) const;
+
+    // Substitution index in pointer-based form with every value fully applied.
+    Unifier::Substitution toSubstitution(std::size_t index) const;
+
+    // Copies every node into store and returns the store ID of each image node.
+    std::vector<TermId> load(TermStore& store) const;
+
+    // On-disk header; magic is "TERMIMG" plus a NUL.
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;  // kByteOrder as written; differs when read on another order
+        std::uint32_t symbolCount;
+        std::uint32_t nodeCount;
+        std::uint32_t argCount;
+        std::uint32_t termCount;
+        std::uint32_t substitutionCount;
+        std::uint32_t bindingCount;
+        std::uint64_t textBytes;
+    };
+
+    struct Cell {
+        Kind kind;
+        std::uint8_t ground;
+        std::uint16_t reserved;
+        SymbolId symbol;
+        std::uint32_t firstArg;  // offset into args
+        std::uint32_t arity;
+    };
+
+    struct Binding {
+        SymbolId variable;
+        TermId value;
+    };
+
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kByteOrder = 0x01020304;
+
+private:
+    std::optional<MappedFile> file_;
+    const Cell* nodes_ = nullptr;
+    const TermId* args_ = nullptr;
+    const TermId* terms_ = nullptr;
+    const std::uint32_t* substitutions_ = nullptr;
+    const Binding* bindings_ = nullptr;
+    const std::uint64_t* symbols_ = nullptr;
+    const char* text_ = nullptr;
+    std::size_t symbolCount_ = 0;
+    std::size_t nodeCount_ = 0;
+    std::size_t termCount_ = 0;
+    std::size_t substitutionCount_ = 0;
+
+    void attach(std::string_view bytes);
+    void validate(std::size_t argCount, std::size_t bindingCount, std::size_t textBytes) const;
+    void validateSubstitution(std::size_t index) const;
+    TermId walk(TermId id, const TermStore::Substitution& sub) const;
+    std::unique_ptr<Term<std::string>> rebuild(TermId id, const TermStore::Substitution* sub) const;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline TermImageWriter::TermImageWriter(const TermStore& store) noexcept : store_(store) {}
+
+inline TermImage::Kind TermImage::kind(TermId id) const noexcept {
+    return nodes_[id].kind;
+}
+
+inline SymbolId TermImage::symbol(TermId id) const noexcept {
+    return nodes_[id].symbol;
+}
+
+inline std::string_view TermImage::name(TermId id) const noexcept {
+    return symbolName(nodes_[id].symbol);
+}
+
+inline std::size_t TermImage::arity(TermId id) const noexcept {
+    return nodes_[id].arity;
+}
+
+inline bool TermImage::isGround(TermId id) const noexcept {
+    return nodes_[id].ground != 0;
+}
+
+inline std::size_t TermImage::size() const noexcept {
+    return nodeCount_;
+}
+
+inline std::string_view TermImage::symbolName(SymbolId id) const noexcept {
+    return std::string_view(text_ + symbols_[id], symbols_[id + 1] - symbols_[id]);
+}
+
+inline std::size_t TermImage::symbolCount() const noexcept {
+    return symbolCount_;
+}
+
+inline std::size_t TermImage::termCount() const noexcept {
+    return termCount_;
+}
+
+inline std::size_t TermImage::substitutionCount() const noexcept {
+    return substitutionCount_;
+}
+
+inline std::unique_ptr<Term<std::string>> TermImage::toTerm(TermId id) const {
+    return rebuild(id, nullptr);
+}
+
+inline std::unique_ptr<Term<std::string>> TermImage::toTerm(
+    TermId id, const TermStore::Substitution& sub) const {
+    return rebuild(id, &sub);
+}
+
+#endif // TERM_IMAGE_H
@@ -0,0 +1,436 @@
+#include "term_image.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'E', 'R', 'M', 'I', 'M', 'G', '\0'};
+
+std::size_t padded(std::size_t bytes) noexcept {
+    return (bytes + 7) & ~std::size_t{7};
+}
+
+// Byte offsets of the sections after the header, in layout order.
+struct Sections {
+    std::size_t nodes, args, terms, substitutions, bindings, symbols, text, end;
+};
+
+[[noreturn]] void malformed(const std::string& what) {
+    throw std::runtime_error("TermImage: " + what);
+}
+
+// Section offsets for h in an image of size bytes. The counts come from the file, so
+// each is checked against the bytes left before it is multiplied, and the running
+// offset only grows by checked adds; a corrupt header cannot make either wrap around.
+Sections sectionsFor(const TermImage::Header& h, std::size_t size) {
+    std::size_t offset = sizeof(TermImage::Header);
+    // start of a section of count elements at offset; moves offset past it and, if pad
+    // is set, its padding
+    const auto section = [&](std::uint64_t count, std::size_t elementSize, bool pad) {
+        const std::size_t left = offset <= size ? size - offset : 0;
+        if (count > left / elementSize) {
+            malformed("section runs past the end of the image");
+        }
+        const std::size_t start = offset;
+        const std::size_t bytes = static_cast<std::size_t>(count) * elementSize;
+        const std::size_t padding = pad ? (8 - bytes % 8) % 8 : 0;
+        offset += bytes;  // cannot wrap: bytes <= size - offset
+        if (padding > std::numeric_limits<std::size_t>::max() - offset) {
+            malformed("section runs past the end of the image");
+        }
+        offset += padding;
+        return start;
+    };
+
+    Sections s;
+    s.nodes = section(h.nodeCount, sizeof(TermImage::Cell), true);
+    s.args = section(h.argCount, sizeof(TermId), true);
+    s.terms = section(h.termCount, sizeof(TermId), true);
+    s.substitutions = section(std::uint64_t{h.substitutionCount} + 1, sizeof(std::uint32_t), true);
+    s.bindings = section(h.bindingCount, sizeof(TermImage::Binding), true);
+    s.symbols = section(std::uint64_t{h.symbolCount} + 1, sizeof(std::uint64_t), false);
+    s.text = section(h.textBytes, 1, true);
+    s.end = offset;
+    return s;
+}
+
+void writeBytes(std::ostream& out, const void* data, std::size_t bytes) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+}
+
+// Zero bytes up to the next 8-byte boundary after a section of the given size.
+void writePadding(std::ostream& out, std::size_t bytes) {
+    static const char zeros[8] = {};
+    writeBytes(out, zeros, padded(bytes) - bytes);
+}
+
+template <typename T>
+void writeSection(std::ostream& out, const std::vector<T>& items) {
+    writeBytes(out, items.data(), items.size() * sizeof(T));
+    writePadding(out, items.size() * sizeof(T));
+}
+
+}  // namespace
+
+// ----------------------------- TermImageWriter ----------------------------
+
+void TermImageWriter::addTerm(TermId id) {
+    if (id >= store_.size()) {
+        throw std::out_of_range("TermImageWriter::addTerm: term not in store");
+    }
+    terms_.push_back(id);
+}
+
+void TermImageWriter::addSubstitution(const TermStore::Substitution& sub) {
+    for (const auto& [var, value] : sub) {
+        if (var >= store_.symbols().size() || value >= store_.size()) {
+            throw std::out_of_range("TermImageWriter::addSubstitution: binding not in store");
+        }
+        bindings_.emplace_back(var, value);
+    }
+    substitutions_.push_back(static_cast<std::uint32_t>(bindings_.size()));
+}
+
+void TermImageWriter::write(std::ostream& out) const {
+    const SymbolTable& symbols = store_.symbols();
+
+    std::vector<TermImage::Cell> nodes;
+    std::vector<TermId> args;
+    nodes.reserve(store_.size());
+    for (TermId id = 0; id < store_.size(); ++id) {
+        const std::size_t arity = store_.arity(id);
+        nodes.push_back(TermImage::Cell{store_.kind(id),
+                                        static_cast<std::uint8_t>(store_.isGround(id)),
+                                        0,
+                                        store_.symbol(id),
+                                        static_cast<std::uint32_t>(args.size()),
+                                        static_cast<std::uint32_t>(arity)});
+        for (std::size_t i = 0; i < arity; ++i) {
+            args.push_back(store_.arg(id, i));
+        }
+    }
+
+    std::vector<TermImage::Binding> bindings;
+    bindings.reserve(bindings_.size());
+    for (const auto& [var, value] : bindings_) {
+        bindings.push_back(TermImage::Binding{var, value});
+    }
+
+    std::vector<std::uint64_t> offsets{0};
+    offsets.reserve(symbols.size() + 1);
+    for (SymbolId id = 0; id < symbols.size(); ++id) {
+        offsets.push_back(offsets.back() + symbols.name(id).size());
+    }
+
+    if (args.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("TermImageWriter: store too large for the image format");
+    }
+
+    TermImage::Header header{};
+    std::memcpy(header.magic, kMagic, sizeof kMagic);
+    header.version = TermImage::kVersion;
+    header.byteOrder = TermImage::kByteOrder;
+    header.symbolCount = static_cast<std::uint32_t>(symbols.size());
+    header.nodeCount = static_cast<std::uint32_t>(nodes.size());
+    header.argCount = static_cast<std::uint32_t>(args.size());
+    header.termCount = static_cast<std::uint32_t>(terms_.size());
+    header.substitutionCount = static_cast<std::uint32_t>(substitutions_.size() - 1);
+    header.bindingCount = static_cast<std::uint32_t>(bindings.size());
+    header.textBytes = offsets.back();
+
+    writeBytes(out, &header, sizeof header);
+    writeSection(out, nodes);
+    writeSection(out, args);
+    writeSection(out, terms_);
+    writeSection(out, substitutions_);
+    writeSection(out, bindings);
+    writeSection(out, offsets);
+    for (SymbolId id = 0; id < symbols.size(); ++id) {
+        const std::string& name = symbols.name(id);
+        writeBytes(out, name.data(), name.size());
+    }
+    writePadding(out, static_cast<std::size_t>(header.textBytes));
+
+    if (!out) {
+        throw std::runtime_error("TermImageWriter: write failed");
+    }
+}
+
+void TermImageWriter::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("TermImageWriter: cannot open " + path);
+    }
+    write(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("TermImageWriter: cannot write " + path);
+    }
+}
+
+// -------------------------------- TermImage -------------------------------
+
+TermImage::TermImage(const std::string& path) : file_(MappedFile(path)) {
+    attach(file_->text());
+}
+
+TermImage::TermImage(const char* data, std::size_t size) {
+    attach(std::string_view(data, size));
+}
+
+TermId TermImage::arg(TermId id, std::size_t index) const {
+    const Cell& node = nodes_[id];
+    if (index >= node.arity) {
+        throw std::out_of_range("TermImage::arg index out of range");
+    }
+    return args_[node.firstArg + index];
+}
+
+TermId TermImage::term(std::size_t index) const {
+    if (index >= termCount_) {
+        throw std::out_of_range("TermImage::term index out of range");
+    }
+    return terms_[index];
+}
+
+TermStore::Substitution TermImage::substitution(std::size_t index) const {
+    if (index >= substitutionCount_) {
+        throw std::out_of_range("TermImage::substitution index out of range");
+    }
+    TermStore::Substitution sub;
+    for (std::uint32_t k = substitutions_[index]; k < substitutions_[index + 1]; ++k) {
+        sub.emplace(bindings_[k].variable, bindings_[k].value);
+    }
+    return sub;
+}
+
+Unifier::Substitution TermImage::toSubstitution(std::size_t index) const {
+    const TermStore::Substitution sub = substitution(index);
+    Unifier::Substitution out;
+    for (const auto& [var, value] : sub) {
+        out[std::string(symbolName(var))] = toTerm(value, sub);
+    }
+    return out;
+}
+
+std::vector<TermId> TermImage::load(TermStore& store) const {
+    // children precede parents, so one forward pass sees every argument mapped already
+    std::vector<TermId> mapped(nodeCount_);
+    std::vector<TermId> args;
+    for (TermId id = 0; id < nodeCount_; ++id) {
+        const Cell& node = nodes_[id];
+        switch (node.kind) {
+        case Kind::Variable:
+            mapped[id] = store.variable(symbolName(node.symbol));
+            break;
+        case Kind::Constant:
+            mapped[id] = store.constant(symbolName(node.symbol));
+            break;
+        case Kind::Compound:
+            args.clear();
+            for (std::uint32_t i = 0; i < node.arity; ++i) {
+                args.push_back(mapped[args_[node.firstArg + i]]);
+            }
+            mapped[id] = store.compound(symbolName(node.symbol), args);
+            break;
+        }
+    }
+    return mapped;
+}
+
+void TermImage::attach(std::string_view bytes) {
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(std::uint64_t) != 0) {
+        malformed("image is not 8-byte aligned");
+    }
+    if (bytes.size() < sizeof(Header)) {
+        malformed("image too short for header");
+    }
+    const auto& header = *reinterpret_cast<const Header*>(bytes.data());
+    if (std::memcmp(header.magic, kMagic, sizeof kMagic) != 0) {
+        malformed("bad magic");
+    }
+    if (header.byteOrder != kByteOrder) {
+        malformed("image written with a different byte order");
+    }
+    if (header.version != kVersion) {
+        malformed("unsupported version " + std::to_string(header.version));
+    }
+    const Sections sections = sectionsFor(header, bytes.size());
+    if (sections.end != bytes.size()) {
+        malformed("size does not match header");
+    }
+
+    const char* base = bytes.data();
+    nodes_ = reinterpret_cast<const Cell*>(base + sections.nodes);
+    args_ = reinterpret_cast<const TermId*>(base + sections.args);
+    terms_ = reinterpret_cast<const TermId*>(base + sections.terms);
+    substitutions_ = reinterpret_cast<const std::uint32_t*>(base + sections.substitutions);
+    bindings_ = reinterpret_cast<const Binding*>(base + sections.bindings);
+    symbols_ = reinterpret_cast<const std::uint64_t*>(base + sections.symbols);
+    text_ = base + sections.text;
+    symbolCount_ = header.symbolCount;
+    nodeCount_ = header.nodeCount;
+    termCount_ = header.termCount;
+    substitutionCount_ = header.substitutionCount;
+
+    validate(header.argCount, header.bindingCount, static_cast<std::size_t>(header.textBytes));
+}
+
+void TermImage::validate(std::size_t argCount, std::size_t bindingCount,
+                         std::size_t textBytes) const {
+    if (symbols_[0] != 0 || symbols_[symbolCount_] != textBytes) {
+        malformed("symbol offsets do not cover the text");
+    }
+    for (std::size_t i = 0; i < symbolCount_; ++i) {
+        if (symbols_[i] > symbols_[i + 1]) {
+            malformed("symbol offsets out of order");
+        }
+    }
+
+    for (TermId id = 0; id < nodeCount_; ++id) {
+        const Cell& node = nodes_[id];
+        if (node.symbol >= symbolCount_) {
+            malformed("node symbol out of range");
+        }
+        bool ground = node.kind != Kind::Variable;
+        switch (node.kind) {
+        case Kind::Variable:
+        case Kind::Constant:
+            if (node.arity != 0) {
+                malformed("only compounds have arguments");
+            }
+            break;
+        case Kind::Compound:
+            if (node.firstArg > argCount || node.arity > argCount - node.firstArg) {
+                malformed("node arguments out of range");
+            }
+            for (std::uint32_t i = 0; i < node.arity; ++i) {
+                // also rules out cycles: every argument is an earlier node
+                const TermId child = args_[node.firstArg + i];
+                if (child >= id) {
+                    malformed("argument does not precede its parent");
+                }
+                ground = ground && nodes_[child].ground != 0;
+            }
+            break;
+        default:
+            malformed("bad node kind");
+        }
+        if ((node.ground != 0) != ground) {
+            malformed("wrong ground flag");
+        }
+    }
+
+    for (std::size_t i = 0; i < termCount_; ++i) {
+        if (terms_[i] >= nodeCount_) {
+            malformed("root term out of range");
+        }
+    }
+    if (substitutions_[0] != 0 || substitutions_[substitutionCount_] != bindingCount) {
+        malformed("substitution offsets do not cover the bindings");
+    }
+    for (std::size_t i = 0; i < substitutionCount_; ++i) {
+        if (substitutions_[i] > substitutions_[i + 1]) {
+            malformed("substitution offsets out of order");
+        }
+    }
+    for (std::size_t k = 0; k < bindingCount; ++k) {
+        if (bindings_[k].variable >= symbolCount_ || bindings_[k].value >= nodeCount_) {
+            malformed("binding out of range");
+        }
+    }
+    for (std::size_t i = 0; i < substitutionCount_; ++i) {
+        validateSubstitution(i);
+    }
+}
+
+void TermImage::validateSubstitution(std::size_t index) const {
+    // one binding per variable, and no variable reachable from its own value; this is
+    // what lets walk() and rebuild() apply a substitution without guarding against loops
+    std::unordered_map<SymbolId, TermId> bound;
+    for (std::uint32_t k = substitutions_[index]; k < substitutions_[index + 1]; ++k) {
+        if (!bound.emplace(bindings_[k].variable, bindings_[k].value).second) {
+            malformed("variable bound twice in one substitution");
+        }
+    }
+
+    // Depth-first over the nodes reachable from the bound values, stepping from a bound
+    // variable into its value. Each non-ground node is explored once: it maps to false
+    // while its subterms are on the stack, and meeting such a node again means a cycle.
+    // Shared subterms are skipped once done, so the cost is linear in nodes and bindings.
+    std::unordered_map<TermId, bool> done;
+    std::vector<std::pair<TermId, bool>> scan;  // (node, leaving it)
+    for (const auto& [var, value] : bound) {
+        scan.emplace_back(value, false);
+        while (!scan.empty()) {
+            const auto [id, leaving] = scan.back();
+            scan.pop_back();
+            if (leaving) {
+                done[id] = true;
+                continue;
+            }
+            const Cell& node = nodes_[id];
+            if (node.ground != 0) {
+                continue;
+            }
+            auto [state, fresh] = done.try_emplace(id, false);
+            if (!fresh) {
+                if (!state->second) {
+                    malformed("cyclic substitution");
+                }
+                continue;
+            }
+            scan.emplace_back(id, true);
+            if (node.kind == Kind::Compound) {
+                for (std::uint32_t a = 0; a < node.arity; ++a) {
+                    scan.emplace_back(args_[node.firstArg + a], false);
+                }
+            } else if (auto it = bound.find(node.symbol); it != bound.end()) {
+                scan.emplace_back(it->second, false);
+            }
+        }
+    }
+}
+
+TermId TermImage::walk(TermId id, const TermStore::Substitution& sub) const {
+    while (nodes_[id].kind == Kind::Variable) {
+        auto it = sub.find(nodes_[id].symbol);
+        if (it == sub.end()) {
+            break;
+        }
+        id = it->second;
+    }
+    return id;
+}
+
+std::unique_ptr<Term<std::string>> TermImage::rebuild(TermId root,
+                                                      const TermStore::Substitution* sub) const {
+    // a local cloner keeps concurrent readers of one image independent
+    TermCloner<TermId> cloner;
+    return cloner.build(root, [&](TermId id, auto& step) {
+        if (sub != nullptr) {
+            id = walk(id, *sub);
+        }
+        const Cell& node = nodes_[id];
+        switch (node.kind) {
+        case Kind::Variable:
+            step.leaf(std::make_unique<Variable>(symbolName(node.symbol)));
+            break;
+        case Kind::Constant:
+            step.leaf(std::make_unique<Constant>(symbolName(node.symbol)));
+            break;
+        case Kind::Compound:
+            step.compound(symbolName(node.symbol), node.arity);
+            for (std::uint32_t i = 0; i < node.arity; ++i) {
+                step.child(args_[node.firstArg + i]);
+            }
+            break;
+        }
+    });
+}
@@ -0,0 +1,167 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "term_format.h"
+#include "term_image.h"
+#include "term_parser.h"
+#include "term_store.h"
+#include "term_test.h"
+
+// Image bytes in an 8-byte aligned buffer, as the in-memory constructor requires.
+struct Buffer {
+    std::vector<std::uint64_t> words;
+    std::size_t size = 0;
+
+    explicit Buffer(const std::string& bytes)
+        : words((bytes.size() + 7) / 8), size(bytes.size()) {
+        std::memcpy(words.data(), bytes.data(), bytes.size());
+    }
+
+    const char* data() const { return reinterpret_cast<const char*>(words.data()); }
+    TermImage::Header& header() { return *reinterpret_cast<TermImage::Header*>(words.data()); }
+};
+
+std::string imageOf(const TermStore& store, const std::vector<TermId>& roots,
+                    const std::vector<TermStore::Substitution>& subs) {
+    TermImageWriter writer(store);
+    for (TermId id : roots) {
+        writer.addTerm(id);
+    }
+    for (const auto& sub : subs) {
+        writer.addSubstitution(sub);
+    }
+    std::ostringstream out;
+    writer.write(out);
+    return out.str();
+}
+
+void testRoundTrip() {
+    TermStore store;
+    const std::vector<TermId> roots =
+        parseClauses("f(X, g(a, 'b c')).\nh(Y, X).\ng(a, 'b c').\n", store);
+    const TermId other = store.compound("f", {store.constant("k"), store.variable("Z")});
+    auto sub = store.unify(roots[0], other);
+    CHECK(sub.has_value());
+
+    Buffer buffer(imageOf(store, roots, {*sub}));
+    TermImage image(buffer.data(), buffer.size);
+    CHECK_EQ(image.size(), store.size());
+    CHECK_EQ(image.termCount(), roots.size());
+    CHECK_EQ(image.symbolCount(), store.symbols().size());
+    for (std::size_t i = 0; i < roots.size(); ++i) {
+        CHECK_EQ(formatTerm(*image.toTerm(image.term(i))), formatTerm(*store.toTerm(roots[i])));
+        CHECK_EQ(image.isGround(image.term(i)), store.isGround(roots[i]));
+    }
+    CHECK_EQ(image.name(image.arg(image.term(0), 0)), "X");
+    CHECK_THROWS(image.arg(image.term(0), 2), std::out_of_range);
+    CHECK_THROWS(image.term(3), std::out_of_range);
+
+    CHECK_EQ(image.substitutionCount(), 1u);
+    CHECK(image.substitution(0) == *sub);
+    CHECK_EQ(formatSubstitution(image.toSubstitution(0)),
+             formatSubstitution(store.toSubstitution(*sub)));
+    CHECK_EQ(formatTerm(*image.toTerm(image.term(1), image.substitution(0))), "h(Y, k)");
+
+    TermStore copy;
+    const std::vector<TermId> mapped = image.load(copy);
+    CHECK_EQ(copy.size(), store.size());
+    CHECK_EQ(formatTerm(*copy.toTerm(mapped[image.term(1)])), "h(Y, X)");
+
+    const std::string path = "/tmp/term_image_test.img";
+    TermImageWriter writer(store);
+    writer.addTerm(roots[2]);
+    writer.save(path);
+    TermImage mappedImage(path);
+    CHECK_EQ(formatTerm(*mappedImage.toTerm(mappedImage.term(0))), "g(a, b c)");
+    std::remove(path.c_str());
+}
+
+// Headers and sections that do not describe the bytes are rejected before any access.
+void testMalformed() {
+    TermStore store;
+    const std::vector<TermId> roots = parseClauses("p(a, X).\n", store);
+    const std::string bytes = imageOf(store, roots, {});
+
+    {
+        Buffer truncated(bytes.substr(0, bytes.size() - 8));
+        CHECK_THROWS(TermImage(truncated.data(), truncated.size), std::runtime_error);
+        CHECK_THROWS(TermImage(truncated.data(), 10), std::runtime_error);
+    }
+    {
+        Buffer bad(bytes);
+        bad.header().magic[0] = 'X';
+        CHECK_THROWS(TermImage(bad.data(), bad.size), std::runtime_error);
+    }
+    {
+        Buffer bad(bytes);
+        bad.header().version = 99;
+        CHECK_THROWS(TermImage(bad.data(), bad.size), std::runtime_error);
+    }
+    {
+        Buffer bad(bytes);
+        CHECK_THROWS(TermImage(bad.data() + 1, bad.size - 1), std::runtime_error);
+    }
+
+    // counts whose byte sizes would wrap a 64-bit offset if multiplied or added unchecked
+    const std::uint64_t huge = std::numeric_limits<std::uint64_t>::max();
+    for (std::uint64_t textBytes : {huge, huge - 6, huge / 2 + 1}) {
+        Buffer bad(bytes);
+        bad.header().textBytes = textBytes;
+        CHECK_THROWS(TermImage(bad.data(), bad.size), std::runtime_error);
+    }
+    for (int field = 0; field < 6; ++field) {
+        Buffer bad(bytes);
+        std::uint32_t* counts[] = {&bad.header().symbolCount, &bad.header().nodeCount,
+                                   &bad.header().argCount, &bad.header().termCount,
+                                   &bad.header().substitutionCount, &bad.header().bindingCount};
+        *counts[field] = std::numeric_limits<std::uint32_t>::max();
+        CHECK_THROWS(TermImage(bad.data(), bad.size), std::runtime_error);
+    }
+
+    // an argument that does not come before its parent (which would allow cycles)
+    {
+        Buffer bad(bytes);
+        const std::size_t nodes = bad.header().nodeCount;
+        auto* args = reinterpret_cast<TermId*>(
+            reinterpret_cast<char*>(bad.words.data()) + sizeof(TermImage::Header) + nodes * 16);
+        args[0] = static_cast<TermId>(nodes - 1);
+        CHECK_THROWS(TermImage(bad.data(), bad.size), std::runtime_error);
+    }
+}
+
+// Checking a substitution visits each shared subterm once: a value whose tree has 2^60
+// paths but only 60 distinct nodes loads at once, and cycles through it are still found.
+void testSharedSubstitution() {
+    TermStore store;
+    const TermId x = store.variable("X");
+    TermId shared = x;
+    for (int k = 0; k < 60; ++k) {
+        shared = store.compound("f", {shared, shared});
+    }
+    const TermId y = store.variable("Y");
+    const SymbolId xs = store.symbol(x);
+    const SymbolId ys = store.symbol(y);
+
+    Buffer buffer(imageOf(store, {shared}, {{{ys, shared}}}));
+    TermImage image(buffer.data(), buffer.size);
+    CHECK_EQ(image.substitutionCount(), 1u);
+
+    const TermId g = store.compound("g", {y});
+    Buffer direct(imageOf(store, {}, {{{xs, shared}}}));
+    CHECK_THROWS(TermImage(direct.data(), direct.size), std::runtime_error);
+    Buffer indirect(imageOf(store, {}, {{{xs, g}, {ys, shared}}}));
+    CHECK_THROWS(TermImage(indirect.data(), indirect.size), std::runtime_error);
+}
+
+int main() {
+    testRoundTrip();
+    testMalformed();
+    testSharedSubstitution();
+    return testSummary();
+}
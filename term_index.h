@@ -0,0 +1,131 @@
+#ifndef TERM_INDEX_H
+#define TERM_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// --------------------------- DiscriminationTree ---------------------------
+// Trie over the preorder symbol sequence of stored terms, where every variable is the
+// wildcard '*'. Retrieval walks the trie with a query term and skips whole subterms where
+// a variable on either side stands for them, so it inspects every level of the term
+// instead of only the first argument.
+// The *Candidates() functions are filters: they never miss a real answer but may keep
+// false positives (repeated variables are not tracked). The other retrieval functions
+// confirm each candidate with Unifier::unify or Unifier::match.
+class DiscriminationTree {
+public:
+    using EntryId = std::size_t;
+
+    // One confirmed retrieval result.
+    struct Match {
+        EntryId entry;
+        Unifier::Substitution substitution;
+    };
+
+    DiscriminationTree();
+    DiscriminationTree(const DiscriminationTree&) = delete;
+    DiscriminationTree& operator=(const DiscriminationTree&) = delete;
+
+    // Stores a term and returns its ID; IDs count up from 0 in insertion order.
+    EntryId insert(std::unique_ptr<Term<std::string>> term);
+
+    const Term<std::string>& term(EntryId id) const;
+    std::size_t size() const noexcept;
+
+    // Stored terms that may unify with query, in insertion order.
+    std::vector<EntryId> unifiableCandidates(const Term<std::string>& query) const;
+
+    // Stored terms that may be instances of query (query is more general).
+    std::vector<EntryId> instanceCandidates(const Term<std::string>& query) const;
+
+    // Stored terms that may be generalizations of query (stored term is more general).
+    std::vector<EntryId> generalizationCandidates(const Term<std::string>& query) const;
+
+    // Stored terms that unify with query, confirmed by unifier.
+    std::vector<Match> unifiable(const Term<std::string>& query, Unifier& unifier) const;
+
+    // Stored terms that are instances of query, confirmed with Unifier::match(query, stored);
+    // substitutions bind the query's variables.
+    std::vector<Match> instances(const Term<std::string>& query, Unifier& unifier) const;
+
+    // Stored terms that generalize query, confirmed with Unifier::match(stored, query);
+    // substitutions bind the stored term's variables.
+    std::vector<Match> generalizations(const Term<std::string>& query, Unifier& unifier) const;
+
+private:
+    using Key = std::uint64_t;
+
+    // Trie node; star is kNoNode when no stored term has a variable at this position.
+    struct Node {
+        std::unordered_map<Key, std::uint32_t> children;
+        std::uint32_t star;
+        std::vector<EntryId> entries;
+    };
+
+    // One preorder position of a query; next is the position just past its subterm.
+    struct QuerySymbol {
+        Key key;  // unused for a variable
+        bool variable;
+        std::uint32_t next;
+    };
+
+    enum class Mode { Unifiable, Instances, Generalizations };
+
+    static constexpr std::uint32_t kNoNode = static_cast<std::uint32_t>(-1);
+
+    std::vector<Node> nodes_;
+    std::vector<std::unique_ptr<Term<std::string>>> terms_;
+
+    static Key makeKey(TermKind kind, SymbolId symbol, std::size_t arity) noexcept;
+    static std::size_t keyArity(Key key) noexcept;
+
+    // Child of node under key, created on first use.
+    std::uint32_t childFor(std::uint32_t node, Key key);
+
+    std::vector<QuerySymbol> flattenQuery(const Term<std::string>& query) const;
+    std::vector<EntryId> retrieve(const Term<std::string>& query, Mode mode) const;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline const Term<std::string>& DiscriminationTree::term(EntryId id) const {
+    return *terms_.at(id);
+}
+
+inline std::size_t DiscriminationTree::size() const noexcept {
+    return terms_.size();
+}
+
+inline DiscriminationTree::Key DiscriminationTree::makeKey(TermKind kind, SymbolId symbol,
+                                                           std::size_t arity) noexcept {
+    return (static_cast<Key>(symbol) << 32) | (static_cast<Key>(arity & 0x3fffffffu) << 2) |
+           static_cast<Key>(kind);
+}
+
+inline std::size_t DiscriminationTree::keyArity(Key key) noexcept {
+    return static_cast<std::size_t>((key >> 2) & 0x3fffffffu);
+}
+
+inline std::vector<DiscriminationTree::EntryId> DiscriminationTree::unifiableCandidates(
+    const Term<std::string>& query) const {
+    return retrieve(query, Mode::Unifiable);
+}
+
+inline std::vector<DiscriminationTree::EntryId> DiscriminationTree::instanceCandidates(
+    const Term<std::string>& query) const {
+    return retrieve(query, Mode::Instances);
+}
+
+inline std::vector<DiscriminationTree::EntryId> DiscriminationTree::generalizationCandidates(
+    const Term<std::string>& query) const {
+    return retrieve(query, Mode::Generalizations);
+}
+
+#endif // TERM_INDEX_H
@@ -0,0 +1,203 @@
+#include "term_index.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+DiscriminationTree::DiscriminationTree() {
+    nodes_.push_back(Node{{}, kNoNode, {}});
+}
+
+DiscriminationTree::EntryId DiscriminationTree::insert(std::unique_ptr<Term<std::string>> term) {
+    if (term == nullptr) {
+        throw std::invalid_argument("DiscriminationTree::insert given a null term");
+    }
+
+    std::uint32_t node = 0;
+    std::vector<const Term<std::string>*> pending{term.get()};
+    while (!pending.empty()) {
+        const Term<std::string>& current = *pending.back();
+        pending.pop_back();
+
+        switch (current.kind()) {
+        case TermKind::Variable:
+            if (nodes_[node].star == kNoNode) {
+                nodes_[node].star = static_cast<std::uint32_t>(nodes_.size());
+                nodes_.push_back(Node{{}, kNoNode, {}});
+            }
+            node = nodes_[node].star;
+            continue;
+        case TermKind::Constant: {
+            node = childFor(node, makeKey(TermKind::Constant, termCast<Constant>(current).id(), 0));
+            continue;
+        }
+        case TermKind::Compound:
+            break;
+        }
+
+        const auto& comp = termCast<Compound<std::string>>(current);
+        node = childFor(node, makeKey(TermKind::Compound, comp.functorId(), comp.arity()));
+        for (std::size_t i = comp.arity(); i > 0; --i) {
+            pending.push_back(&comp.arg(i - 1));
+        }
+    }
+
+    const EntryId id = terms_.size();
+    nodes_[node].entries.push_back(id);
+    terms_.push_back(std::move(term));
+    return id;
+}
+
+std::uint32_t DiscriminationTree::childFor(std::uint32_t node, Key key) {
+    // copy the index out before push_back can move the parent node
+    auto [it, fresh] = nodes_[node].children.try_emplace(key, 0);
+    if (!fresh) {
+        return it->second;
+    }
+    const auto child = static_cast<std::uint32_t>(nodes_.size());
+    it->second = child;
+    nodes_.push_back(Node{{}, kNoNode, {}});
+    return child;
+}
+
+std::vector<DiscriminationTree::Match> DiscriminationTree::unifiable(
+    const Term<std::string>& query, Unifier& unifier) const {
+    std::vector<Match> matches;
+    for (EntryId id : unifiableCandidates(query)) {
+        if (auto sub = unifier.unify(query, *terms_[id])) {
+            matches.push_back(Match{id, std::move(*sub)});
+        }
+    }
+    return matches;
+}
+
+std::vector<DiscriminationTree::Match> DiscriminationTree::instances(
+    const Term<std::string>& query, Unifier& unifier) const {
+    std::vector<Match> matches;
+    for (EntryId id : instanceCandidates(query)) {
+        if (auto sub = unifier.match(query, *terms_[id])) {
+            matches.push_back(Match{id, std::move(*sub)});
+        }
+    }
+    return matches;
+}
+
+std::vector<DiscriminationTree::Match> DiscriminationTree::generalizations(
+    const Term<std::string>& query, Unifier& unifier) const {
+    std::vector<Match> matches;
+    for (EntryId id : generalizationCandidates(query)) {
+        if (auto sub = unifier.match(*terms_[id], query)) {
+            matches.push_back(Match{id, std::move(*sub)});
+        }
+    }
+    return matches;
+}
+
+std::vector<DiscriminationTree::QuerySymbol> DiscriminationTree::flattenQuery(
+    const Term<std::string>& query) const {
+    std::vector<QuerySymbol> flat;
+    // preorder; each compound's entry gets its 'next' patched once its subterm is done
+    std::vector<const Term<std::string>*> pending{&query};
+    std::vector<std::size_t> open;  // indices of compounds whose subterm is still open
+    std::vector<std::size_t> left;  // arguments still to visit for each open compound
+    while (!pending.empty()) {
+        const Term<std::string>& current = *pending.back();
+        pending.pop_back();
+
+        const std::size_t index = flat.size();
+        std::size_t arity = 0;
+        switch (current.kind()) {
+        case TermKind::Variable:
+            flat.push_back(QuerySymbol{0, true, 0});
+            break;
+        case TermKind::Constant:
+            flat.push_back(QuerySymbol{
+                makeKey(TermKind::Constant, termCast<Constant>(current).id(), 0), false, 0});
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(current);
+            arity = comp.arity();
+            flat.push_back(
+                QuerySymbol{makeKey(TermKind::Compound, comp.functorId(), arity), false, 0});
+            for (std::size_t i = arity; i > 0; --i) {
+                pending.push_back(&comp.arg(i - 1));
+            }
+            break;
+        }
+        }
+
+        if (arity > 0) {
+            open.push_back(index);
+            left.push_back(arity);
+            continue;
+        }
+        // a leaf closes its own subterm and possibly a run of enclosing compounds
+        flat[index].next = static_cast<std::uint32_t>(index + 1);
+        while (!open.empty() && --left.back() == 0) {
+            flat[open.back()].next = static_cast<std::uint32_t>(flat.size());
+            open.pop_back();
+            left.pop_back();
+        }
+    }
+    return flat;
+}
+
+std::vector<DiscriminationTree::EntryId> DiscriminationTree::retrieve(
+    const Term<std::string>& query, Mode mode) const {
+    const std::vector<QuerySymbol> flat = flattenQuery(query);
+    const auto end = static_cast<std::uint32_t>(flat.size());
+
+    // skip > 0 means: consume that many whole stored terms before reading query[pos]
+    struct State {
+        std::uint32_t node;
+        std::uint32_t pos;
+        std::size_t skip;
+    };
+    std::vector<State> states{{0, 0, 0}};
+    std::vector<EntryId> found;
+
+    while (!states.empty()) {
+        const State state = states.back();
+        states.pop_back();
+        const Node& node = nodes_[state.node];
+
+        if (state.skip > 0) {
+            for (const auto& [key, child] : node.children) {
+                states.push_back(State{child, state.pos, state.skip - 1 + keyArity(key)});
+            }
+            if (node.star != kNoNode) {
+                states.push_back(State{node.star, state.pos, state.skip - 1});
+            }
+            continue;
+        }
+
+        if (state.pos == end) {
+            found.insert(found.end(), node.entries.begin(), node.entries.end());
+            continue;
+        }
+
+        const QuerySymbol& symbol = flat[state.pos];
+        if (symbol.variable) {
+            if (mode == Mode::Generalizations) {
+                // only a stored variable is at least as general as a query variable
+                if (node.star != kNoNode) {
+                    states.push_back(State{node.star, symbol.next, 0});
+                }
+            } else {
+                states.push_back(State{state.node, symbol.next, 1});
+            }
+            continue;
+        }
+
+        auto it = node.children.find(symbol.key);
+        if (it != node.children.end()) {
+            states.push_back(State{it->second, state.pos + 1, 0});
+        }
+        // a stored variable stands for the whole query subterm, except for instances
+        if (mode != Mode::Instances && node.star != kNoNode) {
+            states.push_back(State{node.star, symbol.next, 0});
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+    return found;
+}
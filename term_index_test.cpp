@@ -0,0 +1,119 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "term_format.h"
+#include "term_index.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+using Ids = std::vector<DiscriminationTree::EntryId>;
+
+const char* const kStored[] = {
+    "f(a, b)", "f(X, b)", "f(g(a), Y)", "f(g(X), X)", "f(X, X)", "f(a)", "g(a, b)",
+    "f(g(h(c)), b)", "a", "X", "f(g(Y), h(Y))",
+};
+
+const char* const kQueries[] = {
+    "f(a, b)", "f(Z, b)", "f(g(Z), W)", "f(g(h(c)), b)", "f(b, a)", "f(Z, Z)",
+    "f(g(b), h(c))", "a", "b", "Z", "f(Z)", "g(Z, W)",
+};
+
+// IDs of the matches.
+Ids ids(const std::vector<DiscriminationTree::Match>& matches) {
+    Ids out;
+    for (const DiscriminationTree::Match& match : matches) {
+        out.push_back(match.entry);
+    }
+    return out;
+}
+
+// True if every ID of wanted is in candidates (both in insertion order).
+bool covers(const Ids& candidates, const Ids& wanted) {
+    std::size_t i = 0;
+    for (DiscriminationTree::EntryId id : wanted) {
+        while (i < candidates.size() && candidates[i] < id) {
+            ++i;
+        }
+        if (i == candidates.size() || candidates[i] != id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every retrieval agrees with trying each stored term in turn, and the candidate filters
+// never drop a real answer.
+void testAgainstScan() {
+    DiscriminationTree tree;
+    std::vector<TermPtr> stored;
+    for (const char* text : kStored) {
+        tree.insert(parseTerm(text));
+        stored.push_back(parseTerm(text));
+    }
+    CHECK_EQ(tree.size(), stored.size());
+    CHECK_EQ(formatTerm(tree.term(3)), "f(g(X), X)");
+
+    Unifier unifier;
+    bool unifiable = true;
+    bool instances = true;
+    bool generalizations = true;
+    bool filters = true;
+    for (const char* text : kQueries) {
+        TermPtr query = parseTerm(text);
+        Ids wantUnify;
+        Ids wantInstance;
+        Ids wantGeneral;
+        for (std::size_t id = 0; id < stored.size(); ++id) {
+            if (unifier.unify(*query, *stored[id])) {
+                wantUnify.push_back(id);
+            }
+            if (unifier.match(*query, *stored[id])) {
+                wantInstance.push_back(id);
+            }
+            if (unifier.match(*stored[id], *query)) {
+                wantGeneral.push_back(id);
+            }
+        }
+        unifiable = unifiable && ids(tree.unifiable(*query, unifier)) == wantUnify;
+        instances = instances && ids(tree.instances(*query, unifier)) == wantInstance;
+        generalizations =
+            generalizations && ids(tree.generalizations(*query, unifier)) == wantGeneral;
+        filters = filters && covers(tree.unifiableCandidates(*query), wantUnify) &&
+                  covers(tree.instanceCandidates(*query), wantInstance) &&
+                  covers(tree.generalizationCandidates(*query), wantGeneral);
+    }
+    CHECK(unifiable);
+    CHECK(instances);
+    CHECK(generalizations);
+    CHECK(filters);
+}
+
+// The filters look past the first argument, and repeated variables are left to the
+// confirming unification.
+void testFiltering() {
+    DiscriminationTree tree;
+    for (const char* text : kStored) {
+        tree.insert(parseTerm(text));
+    }
+    TermPtr deep = parseTerm("f(g(h(d)), b)");
+    CHECK(tree.unifiableCandidates(*deep) == (Ids{1, 3, 4, 9}));
+    TermPtr ground = parseTerm("f(b, a)");
+    CHECK(tree.unifiableCandidates(*ground) == (Ids{4, 9}));
+    Unifier unifier;
+    CHECK(ids(tree.unifiable(*ground, unifier)) == (Ids{9}));
+
+    std::vector<DiscriminationTree::Match> general = tree.generalizations(*deep, unifier);
+    CHECK(ids(general) == (Ids{1, 9}));
+    if (general.size() == 2) {
+        CHECK_EQ(formatSubstitution(general[0].substitution), "X -> g(h(d))");
+    }
+}
+
+int main() {
+    testAgainstScan();
+    testFiltering();
+    return testSummary();
+}
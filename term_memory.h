@@ -0,0 +1,64 @@
+#ifndef TERM_MEMORY_H
+#define TERM_MEMORY_H
+
+#include <cstddef>
+#include <string>
+
+#include "term_unification.h"
+
+// ---------------------------- MemoryFootprint -----------------------------
+// Bytes held by a term, a substitution or a store, broken down by node kind. Node and
+// array sizes are exact; entries of standard-library maps are estimated from the usual
+// node layouts (a few pointers plus the entry), so treat those parts as approximate.
+// Symbol text interned in SymbolRegistry is shared by every term in the process and is
+// not counted for pointer-based terms; stores count their own symbol tables.
+struct MemoryFootprint {
+    struct Part {
+        std::size_t count = 0;  // nodes, cells or entries
+        std::size_t bytes = 0;
+    };
+
+    Part variables;
+    Part constants;
+    Part compounds;             // including their argument arrays
+    Part bindings;              // substitution entries and their keys, not their values
+    std::size_t symbols = 0;    // symbol text and lookup tables owned by the object
+    std::size_t overhead = 0;   // hash tables, work lists and unused reserved capacity
+
+    std::size_t total() const noexcept;
+
+    MemoryFootprint& operator+=(const MemoryFootprint& other) noexcept;
+
+    // Heap bytes behind a std::string: 0 when the text fits in the object itself.
+    static std::size_t heapBytes(const std::string& text) noexcept;
+
+    // Estimated size of one std::map / std::unordered_map entry holding value_size
+    // bytes, including the node's links (buckets of unordered maps are separate).
+    static std::size_t mapEntryBytes(std::size_t valueSize) noexcept;
+    static std::size_t hashEntryBytes(std::size_t valueSize) noexcept;
+};
+
+// Footprint of term and every node below it.
+MemoryFootprint footprint(const Term<std::string>& term);
+
+// Footprint of sub: its entries and keys, plus the footprint of every value term.
+MemoryFootprint footprint(const Unifier::Substitution& sub);
+
+// ------------------------- Inline Implementations ------------------------
+
+inline std::size_t MemoryFootprint::total() const noexcept {
+    return variables.bytes + constants.bytes + compounds.bytes + bindings.bytes + symbols +
+           overhead;
+}
+
+inline std::size_t MemoryFootprint::mapEntryBytes(std::size_t valueSize) noexcept {
+    // red-black node: colour, parent, left, right
+    return 4 * sizeof(void*) + valueSize;
+}
+
+inline std::size_t MemoryFootprint::hashEntryBytes(std::size_t valueSize) noexcept {
+    // singly linked node with a cached hash
+    return sizeof(void*) + valueSize + sizeof(std::size_t);
+}
+
+#endif // TERM_MEMORY_H
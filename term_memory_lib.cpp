@@ -0,0 +1,77 @@
+#include "term_memory.h"
+
+#include <vector>
+
+// ---------------------------- MemoryFootprint -----------------------------
+
+MemoryFootprint& MemoryFootprint::operator+=(const MemoryFootprint& other) noexcept {
+    const auto add = [](Part& part, const Part& more) {
+        part.count += more.count;
+        part.bytes += more.bytes;
+    };
+    add(variables, other.variables);
+    add(constants, other.constants);
+    add(compounds, other.compounds);
+    add(bindings, other.bindings);
+    symbols += other.symbols;
+    overhead += other.overhead;
+    return *this;
+}
+
+std::size_t MemoryFootprint::heapBytes(const std::string& text) noexcept {
+    // small strings live inside the object; anything else is a separate allocation
+    const auto* object = reinterpret_cast<const char*>(&text);
+    const char* data = text.data();
+    if (data >= object && data < object + sizeof(std::string)) {
+        return 0;
+    }
+    return text.capacity() + 1;
+}
+
+// ------------------------------- footprint --------------------------------
+
+MemoryFootprint footprint(const Term<std::string>& term) {
+    MemoryFootprint out;
+    std::vector<const Term<std::string>*> pending{&term};
+    while (!pending.empty()) {
+        const Term<std::string>& current = *pending.back();
+        pending.pop_back();
+        switch (current.kind()) {
+        case TermKind::Variable:
+            ++out.variables.count;
+            out.variables.bytes += sizeof(Variable);
+            break;
+        case TermKind::Constant:
+            ++out.constants.count;
+            out.constants.bytes += sizeof(Constant);
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(current);
+            ++out.compounds.count;
+            out.compounds.bytes += sizeof(Compound<std::string>);
+            if (comp.arity() > Compound<std::string>::kInlineArity) {
+                out.compounds.bytes += comp.arity() * sizeof(Compound<std::string>::TermPtr);
+            }
+            for (std::size_t i = 0; i < comp.arity(); ++i) {
+                pending.push_back(&comp.arg(i));
+            }
+            break;
+        }
+        }
+    }
+    return out;
+}
+
+MemoryFootprint footprint(const Unifier::Substitution& sub) {
+    MemoryFootprint out;
+    for (const auto& [name, value] : sub) {
+        ++out.bindings.count;
+        out.bindings.bytes +=
+            MemoryFootprint::mapEntryBytes(sizeof(Unifier::Substitution::value_type)) +
+            MemoryFootprint::heapBytes(name);
+        if (value != nullptr) {
+            out += footprint(*value);
+        }
+    }
+    return out;
+}
@@ -0,0 +1,78 @@
+#include <memory>
+#include <string>
+
+#include "term_flat.h"
+#include "term_memory.h"
+#include "term_parser.h"
+#include "term_store.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Node counts are exact and the parts add up to the total.
+void testTermFootprint() {
+    TermPtr term = parseTerm("f(X, a, g(X, b), h)");
+    const MemoryFootprint fp = footprint(*term);
+    CHECK_EQ(fp.variables.count, 2u);
+    CHECK_EQ(fp.constants.count, 3u);  // a, b and h
+    CHECK_EQ(fp.compounds.count, 2u);
+    CHECK_EQ(fp.variables.bytes, 2 * sizeof(Variable));
+    CHECK(fp.compounds.bytes >= 2 * sizeof(Compound<std::string>));
+    CHECK_EQ(fp.bindings.count, 0u);
+    CHECK_EQ(fp.symbols, 0u);  // registry text is not counted
+    CHECK_EQ(fp.total(), fp.variables.bytes + fp.constants.bytes + fp.compounds.bytes +
+                             fp.bindings.bytes + fp.symbols + fp.overhead);
+
+    MemoryFootprint sum = fp;
+    sum += footprint(*parseTerm("k(Y)"));
+    CHECK_EQ(sum.variables.count, 3u);
+    CHECK_EQ(sum.compounds.count, 3u);
+
+    Unifier unifier;
+    TermPtr other = parseTerm("f(c, Z, g(c, b), h)");
+    auto sub = unifier.unify(*term, *other);
+    CHECK(sub.has_value());
+    if (sub) {
+        const MemoryFootprint bound = footprint(*sub);
+        CHECK_EQ(bound.bindings.count, 2u);  // X and Z
+        CHECK_EQ(bound.constants.count, 2u);  // their values
+        CHECK(bound.bindings.bytes > 0u);
+    }
+}
+
+// Stores count their nodes and symbols; compacting gives back spare capacity only.
+void testStoreFootprint() {
+    TermPtr term = parseTerm("f(X, a, g(X, b), h)");
+    TermStore store;
+    const TermId id = store.intern(*term);
+    MemoryFootprint fp = store.memoryFootprint();
+    CHECK_EQ(fp.variables.count, 1u);  // hash-consed: X is stored once
+    CHECK_EQ(fp.constants.count, 3u);
+    CHECK_EQ(fp.compounds.count, 2u);
+    CHECK(fp.symbols > 0u);
+
+    const std::size_t before = fp.total();
+    store.shrinkToFit();
+    const MemoryFootprint compact = store.memoryFootprint();
+    CHECK(compact.total() <= before);
+    CHECK_EQ(compact.compounds.bytes, fp.compounds.bytes);
+    CHECK_EQ(store.intern(*term), id);
+    CHECK(store.compound("k", {id}) != id);
+
+    FlatHeap heap;
+    heap.encode(*term);
+    const MemoryFootprint flat = heap.memoryFootprint();
+    CHECK_EQ(flat.variables.count, 3u);  // X's own cell and the two arguments referring to it
+    CHECK_EQ(flat.constants.count, 3u);
+    CHECK_EQ(flat.compounds.count, 2u);
+    // 8-byte cells: the root structure pointer, two functor headers, six arguments and
+    // X's cell
+    CHECK_EQ(flat.variables.bytes + flat.constants.bytes + flat.compounds.bytes, 10 * 8u);
+}
+
+int main() {
+    testTermFootprint();
+    testStoreFootprint();
+    return testSummary();
+}
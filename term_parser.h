@@ -0,0 +1,175 @@
+#ifndef TERM_PARSER_H
+#define TERM_PARSER_H
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "term_batch.h"
+#include "term_store.h"
+#include "term_unification.h"
+
+// Syntax accepted by the parser (the same syntax TermFormatter emits):
+//   term     := variable | atom | atom '(' [term {',' term}] ')'
+//   variable := [A-Z_][A-Za-z0-9_]*        each bare '_' is a fresh variable
+//   atom     := [a-z0-9][A-Za-z0-9_]* | '\'' chars '\''   quotes allow \\, \' and \n
+//   clause   := term '.'
+// A bare '_' is named by SymbolRegistry::freshVariable(), so anonymous variables are
+// distinct across clauses, parsers and threads, not just within one clause. The names
+// it gives are ordinary variable names, so formatted output parses back unchanged.
+// Whitespace separates tokens, and '%' starts a comment running to the end of the line.
+// Quoted atoms cannot span lines (a newline inside one is written \n), which is what
+// lets parseClauses() split a file at clause ends without tokenizing it first.
+
+// ------------------------------- ParseError -------------------------------
+class ParseError : public std::runtime_error {
+public:
+    ParseError(const std::string& what, std::size_t offset);
+
+    // Byte offset into the parsed text where the problem was found.
+    std::size_t offset() const noexcept;
+
+private:
+    std::size_t offset_;
+};
+
+// ------------------------------- TermParser -------------------------------
+// Streaming parser over a borrowed buffer: each call to next() parses one clause, so a
+// large file never needs more than one clause's worth of parser state.
+// Tokens are views into the text; the only copies made are the names stored in the
+// built nodes. Nesting depth is limited by memory only, not by the call stack.
+class TermParser {
+public:
+    // text must outlive the parser. Reading starts at byte offset start, which must be a
+    // clause boundary; offsets reported by errors stay relative to the whole of text.
+    explicit TermParser(std::string_view text, std::size_t start = 0) noexcept;
+
+    // Next clause as a pointer-based term, or nullptr at the end of the input.
+    // Throws ParseError on malformed input.
+    std::unique_ptr<Term<std::string>> next();
+
+    // Same, building the clause directly into store (shared with what it holds already).
+    std::optional<TermId> next(TermStore& store);
+
+    // Like next(), but the closing '.' is optional; for reading a single term.
+    std::unique_ptr<Term<std::string>> nextTerm();
+
+    // True once only whitespace and comments remain.
+    bool atEnd();
+
+    // Byte offset of the next unread character.
+    std::size_t offset() const noexcept;
+
+private:
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    std::string unescaped_;  // text of the last quoted atom that had escapes
+
+    struct Token {
+        std::string_view text;
+        bool variable;
+    };
+
+    // Compound whose arguments are still being parsed; they sit on the builder's argument
+    // stack from firstArg up. A functor with escapes is kept in spelled, since
+    // unescaped_ is reused by the next quoted atom.
+    struct Frame {
+        std::string_view functor;
+        std::string spelled;
+        bool escaped;
+        std::size_t firstArg;
+    };
+
+    // Scratch reused across clauses.
+    std::vector<Frame> frames_;
+    std::vector<std::unique_ptr<Term<std::string>>> termArgs_;
+    std::vector<TermId> idArgs_;
+    std::vector<SymbolId> fresh_;  // names given to the current clause's bare '_'s
+
+    template <typename Builder>
+    typename Builder::Node parseClause(Builder& builder, bool requireEnd);
+
+    template <typename Builder>
+    typename Builder::Node parseTerm(Builder& builder);
+
+    // Pops the innermost open compound and pushes it, built, as a finished argument.
+    template <typename Builder>
+    void closeFrame(Builder& builder);
+
+    void skipLayout() noexcept;
+    Token readName();
+    std::string_view readQuoted(bool& escaped);
+    [[noreturn]] void fail(const std::string& what) const;
+};
+
+// -------------------------------- Helpers ---------------------------------
+
+// Parses one term (a trailing '.' is optional); throws ParseError unless text holds
+// exactly one term.
+std::unique_ptr<Term<std::string>> parseTerm(std::string_view text);
+
+// Parses every clause of text, in input order.
+std::vector<std::unique_ptr<Term<std::string>>> parseClauses(std::string_view text);
+
+// Same, splitting text into chunks at clause ends and parsing the chunks on pool.
+// A chunk boundary is a newline right after a line that ends in '.' and holds no quote or
+// '%', so any such line is known to end a clause without parsing what precedes it.
+// Names a worker has seen before are interned without locking (see SymbolRegistry).
+// Throws the ParseError of the earliest failing chunk.
+std::vector<std::unique_ptr<Term<std::string>>> parseClauses(std::string_view text,
+                                                             ThreadPool& pool);
+
+// Parses every clause of text into store (single-threaded; TermStore is not shared).
+std::vector<TermId> parseClauses(std::string_view text, TermStore& store);
+
+// ------------------------------- MappedFile -------------------------------
+// Read-only memory mapping of a whole file, for handing to the parser without reading
+// it into a buffer first. Throws std::system_error if the file cannot be opened or mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    std::string_view text() const noexcept;
+    std::size_t size() const noexcept;
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    void unmap() noexcept;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline ParseError::ParseError(const std::string& what, std::size_t offset)
+    : std::runtime_error(what), offset_(offset) {}
+
+inline std::size_t ParseError::offset() const noexcept {
+    return offset_;
+}
+
+inline TermParser::TermParser(std::string_view text, std::size_t start) noexcept
+    : text_(text), pos_(start) {}
+
+inline std::size_t TermParser::offset() const noexcept {
+    return pos_;
+}
+
+inline std::string_view MappedFile::text() const noexcept {
+    return std::string_view(data_, size_);
+}
+
+inline std::size_t MappedFile::size() const noexcept {
+    return size_;
+}
+
+#endif // TERM_PARSER_H
@@ -0,0 +1,434 @@
+#include "term_parser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Builders give parseTerm one interface over both targets. Each owns no state beyond the
+// argument stack it borrows from the parser, so it is cheap to make per clause.
+struct TermBuilder {
+    using Node = std::unique_ptr<Term<std::string>>;
+
+    std::vector<Node>& args;
+
+    Node variable(std::string_view name) { return std::make_unique<Variable>(name); }
+
+    Node freshVariable(SymbolRegistry::InternedSymbol symbol) {
+        return std::make_unique<Variable>(symbol);
+    }
+
+    Node constant(std::string_view name) { return std::make_unique<Constant>(name); }
+
+    Node compound(std::string_view functor, Node* first, std::size_t count) {
+        return Compound<std::string>::makeFrom(functor, first, count);
+    }
+};
+
+struct StoreBuilder {
+    using Node = TermId;
+
+    std::vector<Node>& args;
+    TermStore& store;
+
+    Node variable(std::string_view name) { return store.variable(name); }
+
+    Node freshVariable(SymbolRegistry::InternedSymbol symbol) {
+        return store.variable(*symbol.text);
+    }
+
+    Node constant(std::string_view name) { return store.constant(name); }
+
+    Node compound(std::string_view functor, Node* first, std::size_t count) {
+        return store.compound(functor, std::vector<TermId>(first, first + count));
+    }
+};
+
+bool isNameChar(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_';
+}
+
+bool startsVariable(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// True for names of the form _N, the ones SymbolRegistry::freshVariable() hands out.
+bool isFreshName(std::string_view name) noexcept {
+    if (name.size() < 2 || name[0] != '_') {
+        return false;
+    }
+    for (std::size_t i = 1; i < name.size(); ++i) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Offset just past the first newline at or after from that ends a clause line (see
+// parseClauses), or text.size() when there is none.
+std::size_t nextSplit(std::string_view text, std::size_t from) {
+    while (from < text.size()) {
+        const std::size_t newline = text.find('\n', from);
+        if (newline == std::string_view::npos) {
+            return text.size();
+        }
+        const std::size_t previous = newline == 0 ? std::string_view::npos
+                                                  : text.rfind('\n', newline - 1);
+        const std::size_t begin = previous == std::string_view::npos ? 0 : previous + 1;
+        const std::string_view line = text.substr(begin, newline - begin);
+        const std::size_t last = line.find_last_not_of(" \t\r");
+        if (last != std::string_view::npos && line[last] == '.' &&
+            line.find_first_of("%'") == std::string_view::npos) {
+            return newline + 1;
+        }
+        from = newline + 1;
+    }
+    return text.size();
+}
+
+}  // namespace
+
+// ------------------------------- TermParser -------------------------------
+
+std::unique_ptr<Term<std::string>> TermParser::next() {
+    if (atEnd()) {
+        return nullptr;
+    }
+    TermBuilder builder{termArgs_};
+    return parseClause(builder, true);
+}
+
+std::optional<TermId> TermParser::next(TermStore& store) {
+    if (atEnd()) {
+        return std::nullopt;
+    }
+    StoreBuilder builder{idArgs_, store};
+    return parseClause(builder, true);
+}
+
+std::unique_ptr<Term<std::string>> TermParser::nextTerm() {
+    if (atEnd()) {
+        return nullptr;
+    }
+    TermBuilder builder{termArgs_};
+    return parseClause(builder, false);
+}
+
+bool TermParser::atEnd() {
+    skipLayout();
+    return pos_ >= text_.size();
+}
+
+template <typename Builder>
+typename Builder::Node TermParser::parseClause(Builder& builder, bool requireEnd) {
+    typename Builder::Node clause = parseTerm(builder);
+    skipLayout();
+    if (pos_ < text_.size() && text_[pos_] == '.') {
+        ++pos_;
+    } else if (requireEnd) {
+        fail("expected '.' at end of clause");
+    }
+    return clause;
+}
+
+template <typename Builder>
+typename Builder::Node TermParser::parseTerm(Builder& builder) {
+    // Explicit stack of open compounds: each finished term becomes the next argument of
+    // the innermost open compound, and every ')' turns that compound into a finished term.
+    const std::size_t start = pos_;
+    frames_.clear();
+    builder.args.clear();
+    fresh_.clear();
+    for (;;) {
+        skipLayout();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end of input");
+        }
+
+        bool escaped = false;
+        const Token token = text_[pos_] == '\'' ? Token{readQuoted(escaped), false} : readName();
+        if (token.variable) {
+            if (token.text == "_") {
+                const SymbolRegistry::InternedSymbol symbol = SymbolRegistry::freshVariable();
+                fresh_.push_back(symbol.id);
+                builder.args.push_back(builder.freshVariable(symbol));
+            } else {
+                // A hand-written _N is interned right away so no later '_' is named after
+                // it. If an earlier '_' of this clause already was, the clause is parsed
+                // again from the start; the new fresh names skip _N. Nodes already put in
+                // a TermStore by the abandoned attempt stay there.
+                if (isFreshName(token.text)) {
+                    const SymbolId id = SymbolRegistry::variable(token.text);
+                    if (std::find(fresh_.begin(), fresh_.end(), id) != fresh_.end()) {
+                        pos_ = start;
+                        frames_.clear();
+                        builder.args.clear();
+                        fresh_.clear();
+                        continue;
+                    }
+                }
+                builder.args.push_back(builder.variable(token.text));
+            }
+        } else {
+            skipLayout();
+            if (pos_ < text_.size() && text_[pos_] == '(') {
+                ++pos_;
+                frames_.push_back(Frame{token.text, std::string(), escaped, builder.args.size()});
+                if (escaped) {
+                    frames_.back().spelled.assign(token.text);
+                }
+                skipLayout();
+                if (pos_ >= text_.size() || text_[pos_] != ')') {
+                    continue;  // on to the first argument
+                }
+                ++pos_;
+                closeFrame(builder);  // f()
+            } else {
+                builder.args.push_back(builder.constant(token.text));
+            }
+        }
+
+        // a term is finished: close compounds for as long as ')' follows it
+        for (;;) {
+            if (frames_.empty()) {
+                typename Builder::Node result = std::move(builder.args.back());
+                builder.args.clear();
+                return result;
+            }
+            skipLayout();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                break;
+            }
+            if (pos_ < text_.size() && text_[pos_] == ')') {
+                ++pos_;
+                closeFrame(builder);
+                continue;
+            }
+            fail("expected ',' or ')'");
+        }
+    }
+}
+
+template <typename Builder>
+void TermParser::closeFrame(Builder& builder) {
+    Frame& frame = frames_.back();
+    const std::size_t count = builder.args.size() - frame.firstArg;
+    auto node = builder.compound(frame.escaped ? std::string_view(frame.spelled) : frame.functor,
+                                 builder.args.data() + frame.firstArg, count);
+    builder.args.resize(frame.firstArg);
+    frames_.pop_back();
+    builder.args.push_back(std::move(node));
+}
+
+void TermParser::skipLayout() noexcept {
+    while (pos_ < text_.size()) {
+        const char c = text_[pos_];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++pos_;
+        } else if (c == '%') {
+            const std::size_t newline = text_.find('\n', pos_);
+            pos_ = newline == std::string_view::npos ? text_.size() : newline + 1;
+        } else {
+            break;
+        }
+    }
+}
+
+TermParser::Token TermParser::readName() {
+    const std::size_t begin = pos_;
+    while (pos_ < text_.size() && isNameChar(text_[pos_])) {
+        ++pos_;
+    }
+    if (pos_ == begin) {
+        fail(std::string("unexpected character '") + text_[pos_] + "'");
+    }
+    return Token{text_.substr(begin, pos_ - begin), startsVariable(text_[begin])};
+}
+
+std::string_view TermParser::readQuoted(bool& escaped) {
+    const std::size_t open = pos_++;
+    const std::size_t begin = pos_;
+    escaped = false;
+    while (pos_ < text_.size()) {
+        const char c = text_[pos_];
+        if (c == '\'') {
+            ++pos_;
+            return escaped ? std::string_view(unescaped_) : text_.substr(begin, pos_ - 1 - begin);
+        }
+        if (c == '\n') {
+            break;
+        }
+        if (c == '\\') {
+            const char next = pos_ + 1 < text_.size() ? text_[pos_ + 1] : '\0';
+            if (next != '\\' && next != '\'' && next != 'n') {
+                fail("unknown escape in quoted atom");
+            }
+            if (!escaped) {
+                escaped = true;
+                unescaped_.assign(text_.substr(begin, pos_ - begin));
+            }
+            unescaped_.push_back(next == 'n' ? '\n' : next);
+            pos_ += 2;
+            continue;
+        }
+        if (escaped) {
+            unescaped_.push_back(c);
+        }
+        ++pos_;
+    }
+    pos_ = open;
+    fail("unterminated quoted atom");
+}
+
+void TermParser::fail(const std::string& what) const {
+    throw ParseError(what + " at offset " + std::to_string(pos_), pos_);
+}
+
+// -------------------------------- Helpers ---------------------------------
+
+std::unique_ptr<Term<std::string>> parseTerm(std::string_view text) {
+    TermParser parser(text);
+    std::unique_ptr<Term<std::string>> term = parser.nextTerm();
+    if (!term) {
+        throw ParseError("no term in input", parser.offset());
+    }
+    if (!parser.atEnd()) {
+        throw ParseError("unexpected text after term at offset " + std::to_string(parser.offset()),
+                         parser.offset());
+    }
+    return term;
+}
+
+std::vector<std::unique_ptr<Term<std::string>>> parseClauses(std::string_view text) {
+    std::vector<std::unique_ptr<Term<std::string>>> clauses;
+    TermParser parser(text);
+    while (auto clause = parser.next()) {
+        clauses.push_back(std::move(clause));
+    }
+    return clauses;
+}
+
+std::vector<std::unique_ptr<Term<std::string>>> parseClauses(std::string_view text,
+                                                             ThreadPool& pool) {
+    // a few chunks per worker so stealing can even out clauses of uneven size
+    const std::size_t wanted = pool.size() * 4;
+    std::vector<std::size_t> bounds{0};
+    for (std::size_t k = 1; k < wanted; ++k) {
+        const std::size_t target = text.size() / wanted * k;
+        if (target <= bounds.back()) {
+            continue;
+        }
+        const std::size_t split = nextSplit(text, target);
+        if (split >= text.size()) {
+            break;
+        }
+        if (split > bounds.back()) {
+            bounds.push_back(split);
+        }
+    }
+    bounds.push_back(text.size());
+
+    const std::size_t chunks = bounds.size() - 1;
+    std::vector<std::vector<std::unique_ptr<Term<std::string>>>> parsed(chunks);
+    std::vector<std::exception_ptr> errors(chunks);
+    pool.parallelFor(chunks, 1, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            try {
+                // the parser sees the text up to the chunk's end, so offsets stay absolute
+                TermParser parser(text.substr(0, bounds[c + 1]), bounds[c]);
+                while (auto clause = parser.next()) {
+                    parsed[c].push_back(std::move(clause));
+                }
+            } catch (...) {
+                errors[c] = std::current_exception();
+            }
+        }
+    });
+
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        if (errors[c]) {
+            std::rethrow_exception(errors[c]);
+        }
+        total += parsed[c].size();
+    }
+    std::vector<std::unique_ptr<Term<std::string>>> clauses;
+    clauses.reserve(total);
+    for (auto& chunk : parsed) {
+        for (auto& clause : chunk) {
+            clauses.push_back(std::move(clause));
+        }
+    }
+    return clauses;
+}
+
+std::vector<TermId> parseClauses(std::string_view text, TermStore& store) {
+    std::vector<TermId> clauses;
+    TermParser parser(text);
+    while (std::optional<TermId> clause = parser.next(store)) {
+        clauses.push_back(*clause);
+    }
+    return clauses;
+}
+
+// ------------------------------- MappedFile -------------------------------
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "cannot stat " + path);
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0) {  // mmap rejects a zero length; an empty file maps to an empty view
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "cannot map " + path);
+        }
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+    }
+    ::close(fd);  // the mapping stays valid without the descriptor
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+void MappedFile::unmap() noexcept {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
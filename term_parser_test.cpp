@@ -0,0 +1,210 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "term_batch.h"
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_store.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Formatted text with every anonymous variable written as '_', for comparing parses that
+// drew different fresh names.
+std::string shape(const Term<std::string>& term) {
+    static const std::regex anonymous("_[0-9]+");
+    return std::regex_replace(formatTerm(term), anonymous, "_");
+}
+
+void testTerms() {
+    CHECK_EQ(formatTerm(*parseTerm("f(X, g(a, 'b c'), Y)")), "f(X, g(a, b c), Y)");
+    CHECK_EQ(formatTerm(*parseTerm("  p . ")), "p");
+    CHECK_EQ(formatTerm(*parseTerm("f() % trailing comment")), "f()");
+}
+
+void testErrors() {
+    CHECK_THROWS(parseTerm("f(a"), ParseError);
+    CHECK_THROWS(parseTerm("f(a,)"), ParseError);
+    CHECK_THROWS(parseTerm("a b"), ParseError);
+    CHECK_THROWS(parseTerm("'open"), ParseError);
+    CHECK_THROWS(parseTerm(""), ParseError);
+    try {
+        parseTerm("f(a, ?)");
+        CHECK(false);
+    } catch (const ParseError& error) {
+        CHECK_EQ(error.offset(), 5u);
+    }
+}
+
+// Each bare '_' is a new variable, also across separate parses.
+void testAnonymous() {
+    TermPtr left = parseTerm("p(_, b)");
+    TermPtr right = parseTerm("p(a, _)");
+    Unifier unifier;
+    auto result = unifier.unify(*left, *right);
+    CHECK(result.has_value());
+    if (result) {
+        CHECK_EQ(result->size(), 2u);
+    }
+
+    TermPtr pair = parseTerm("q(_, _)");
+    const auto& args = termCast<Compound<std::string>>(*pair);
+    CHECK(termCast<Variable>(args.arg(0)).id() != termCast<Variable>(args.arg(1)).id());
+    CHECK(unifier.unify(*pair, *parseTerm("q(a, b)")).has_value());
+
+}
+
+// Parseable output of a term with anonymous variables reads back as the same term, with
+// the same variables.
+void testAnonymousRoundTrip() {
+    TermPtr term = parseTerm("f(_, X, g(_, 'b c'), _)");
+    const std::string text = formatTerm(*term, Quoting::Parseable);
+    TermPtr again = parseTerm(text);
+    CHECK_EQ(formatTerm(*again, Quoting::Parseable), text);
+    Unifier unifier;
+    auto result = unifier.unify(*term, *again);
+    CHECK(result.has_value());
+    if (result) {
+        CHECK(result->empty());
+    }
+
+    // a fresh name never reuses one interned before, even if written by hand
+    const std::string last = formatTerm(*parseTerm("_"));
+    const std::string next = "_" + std::to_string(std::stoul(last.substr(1)) + 1);
+    parseTerm(next);
+    CHECK(formatTerm(*parseTerm("_")) != next);
+}
+
+// A '_' takes no name that is written by hand later in the same clause.
+void testAnonymousBeforeNamed() {
+    // name(k) is the k-th name freshVariable() will try after the current one
+    const std::size_t base = std::stoul(formatTerm(*parseTerm("_")).substr(1)) + 1;
+    const auto name = [base](std::size_t k) { return "_" + std::to_string(base + k); };
+
+    TermPtr term = parseTerm("f(_, " + name(0) + ", " + name(1) + ")");
+    const auto& args = termCast<Compound<std::string>>(*term);
+    CHECK(formatTerm(args.arg(0)) != name(0));
+    CHECK(formatTerm(args.arg(0)) != name(1));
+    CHECK_EQ(formatTerm(args.arg(1)), name(0));
+    Unifier unifier;
+    CHECK(unifier.unify(*term, *parseTerm("f(a, b, c)")).has_value());
+
+    TermStore store;
+    const std::vector<TermId> ids =
+        parseClauses("g(_, " + name(3) + ", " + name(4) + ", _).", store);
+    CHECK_EQ(ids.size(), 1u);
+    if (ids.size() == 1) {
+        CHECK(unifier.unify(*store.toTerm(ids[0]), *parseTerm("g(a, b, c, d)")).has_value());
+    }
+}
+
+void testClauses() {
+    const std::string text =
+        "edge(a, b).\n"
+        "edge(b, c).  % comment\n"
+        "path(X, Y) .\n"
+        "quoted('a.\\nb', _).\n";
+    const std::vector<TermPtr> clauses = parseClauses(text);
+    CHECK_EQ(clauses.size(), 4u);
+    if (clauses.size() == 4) {
+        CHECK_EQ(formatTerm(*clauses[3], Quoting::Parseable).substr(0, 15), "quoted('a.\\nb',");
+    }
+    CHECK_THROWS(parseClauses("a.\nb"), ParseError);
+
+    TermStore store;
+    const std::vector<TermId> ids = parseClauses(text, store);
+    CHECK_EQ(ids.size(), 4u);
+    if (ids.size() == 4) {
+        CHECK_EQ(formatTerm(*store.toTerm(ids[0])), "edge(a, b)");
+        CHECK(store.toTerm(ids[1]) != nullptr);
+    }
+}
+
+// Chunked parsing on a pool gives the sequential result, and reports the first error.
+void testParallelClauses() {
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text += "fact(" + std::to_string(i) + ", f(X, _), 'q " + std::to_string(i % 7) + "').\n";
+        if (i % 100 == 0) {
+            text += "% a comment line.\nmulti(a,\n      b).\n";
+        }
+    }
+    const std::vector<TermPtr> sequential = parseClauses(text);
+    for (std::size_t workers : {1, 2, 4}) {
+        ThreadPool pool(workers);
+        const std::vector<TermPtr> parallel = parseClauses(text, pool);
+        CHECK_EQ(parallel.size(), sequential.size());
+        std::size_t same = 0;
+        for (std::size_t i = 0; i < parallel.size() && i < sequential.size(); ++i) {
+            same += shape(*parallel[i]) == shape(*sequential[i]) ? 1 : 0;
+        }
+        CHECK_EQ(same, sequential.size());
+    }
+
+    std::string broken = text;
+    const std::size_t first = broken.find("fact(1000,");
+    const std::size_t second = broken.find("fact(2000,");
+    broken[first + 4] = '?';
+    broken[second + 4] = '?';
+    ThreadPool pool(4);
+    try {
+        parseClauses(broken, pool);
+        CHECK(false);
+    } catch (const ParseError& error) {
+        CHECK_EQ(error.offset(), first + 4);
+    }
+}
+
+// Deep nesting is limited by memory, not by the call stack.
+void testDeep() {
+    const std::size_t depth = 100000;
+    std::string text;
+    for (std::size_t i = 0; i < depth; ++i) {
+        text += "s(";
+    }
+    text += "z";
+    text.append(depth, ')');
+    TermPtr term = parseTerm(text);
+    std::size_t levels = 0;
+    for (const Term<std::string>* t = term.get(); t->isCompound();
+         t = &termCast<Compound<std::string>>(*t).arg(0)) {
+        ++levels;
+    }
+    CHECK_EQ(levels, depth);
+}
+
+void testMappedFile() {
+    const std::string path = "/tmp/term_parser_test.pl";
+    {
+        std::ofstream out(path);
+        out << "a.\nb(X).\n";
+    }
+    {
+        MappedFile file(path);
+        CHECK_EQ(file.size(), 9u);
+        CHECK_EQ(parseClauses(file.text()).size(), 2u);
+        MappedFile moved(std::move(file));
+        CHECK_EQ(moved.text(), "a.\nb(X).\n");
+    }
+    std::remove(path.c_str());
+    CHECK_THROWS(MappedFile("/tmp/term_parser_test_missing.pl"), std::system_error);
+}
+
+int main() {
+    testTerms();
+    testErrors();
+    testAnonymous();
+    testAnonymousRoundTrip();
+    testAnonymousBeforeNamed();
+    testClauses();
+    testParallelClauses();
+    testDeep();
+    testMappedFile();
+    return testSummary();
+}
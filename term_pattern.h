@@ -0,0 +1,265 @@
+#ifndef TERM_PATTERN_H
+#define TERM_PATTERN_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// ------------------------------- Patterns ---------------------------------
+// Terms whose shape is fixed at compile time, e.g. edge(X, Y):
+//
+//     using namespace pattern;
+//     static const auto edge = compile(compound("edge", var<0>(), var<1>()));
+//     if (auto captures = edge.match(term)) { use((*captures)[0], (*captures)[1]); }
+//
+// The pattern is a type, so compile() turns it into straight-line match code: each
+// position checks kind, symbol ID and arity directly, with no work stack and no
+// dispatch on the pattern side. Matching is one-way like Unifier::match: var<I>()
+// captures the subject subterm at its position (repeated captures must be identical)
+// and subject variables only match pattern variables.
+namespace pattern {
+
+// Capture slot I.
+template <std::size_t I>
+struct Var {};
+
+// Constant with the given text.
+struct Atom {
+    std::string_view text;
+};
+
+// functor(args...).
+template <typename... Args>
+struct Node {
+    std::string_view functor;
+    std::tuple<Args...> args;
+};
+
+template <std::size_t I>
+constexpr Var<I> var() noexcept;
+
+constexpr Atom atom(std::string_view text) noexcept;
+
+template <typename... Args>
+constexpr Node<Args...> compound(std::string_view functor, Args... args);
+
+namespace detail {
+
+// Number of atoms and functors in a pattern (its length in Compiled::symbols_).
+template <typename P>
+struct Shape;
+
+template <std::size_t I>
+struct Shape<Var<I>> {
+    static constexpr std::size_t symbols = 0;
+    static constexpr std::size_t variables = I + 1;
+};
+
+template <>
+struct Shape<Atom> {
+    static constexpr std::size_t symbols = 1;
+    static constexpr std::size_t variables = 0;
+};
+
+template <typename... Args>
+struct Shape<Node<Args...>> {
+    static constexpr std::size_t symbols = (std::size_t{1} + ... + Shape<Args>::symbols);
+    static constexpr std::size_t variables =
+        std::max({std::size_t{0}, Shape<Args>::variables...});
+};
+
+// Preorder slot of argument J of a node at Slot: one past the functor, then every
+// earlier sibling's symbols.
+template <std::size_t Slot, std::size_t J, typename... Args>
+constexpr std::size_t argSlot() noexcept {
+    constexpr std::size_t counts[] = {Shape<Args>::symbols..., 0};
+    std::size_t slot = Slot + 1;
+    for (std::size_t k = 0; k < J; ++k) {
+        slot += counts[k];
+    }
+    return slot;
+}
+
+}  // namespace detail
+
+// Number of atoms and functors in P, and one past its largest variable index.
+template <typename P>
+constexpr std::size_t symbolCount() noexcept {
+    return detail::Shape<P>::symbols;
+}
+
+template <typename P>
+constexpr std::size_t variableCount() noexcept {
+    return detail::Shape<P>::variables;
+}
+
+// Pattern P with its atoms and functors interned once, ready to match.
+template <typename P>
+class Compiled {
+public:
+    // One slot per variable index up to the largest used; unused slots stay nullptr.
+    using Captures = std::array<const Term<std::string>*, variableCount<P>()>;
+
+    explicit Compiled(const P& pattern);
+
+    // Captured subterms (pointing into subject) when subject is an instance of the
+    // pattern, std::nullopt otherwise.
+    std::optional<Captures> match(const Term<std::string>& subject) const;
+
+    // Same, writing into captures; returns false on mismatch (captures then partial).
+    bool match(const Term<std::string>& subject, Captures& captures) const;
+
+private:
+    // Symbol IDs of the pattern's atoms and functors in preorder.
+    std::array<SymbolId, symbolCount<P>()> symbols_;
+
+    template <std::size_t Slot, std::size_t I>
+    void intern(const Var<I>& sub) noexcept;
+
+    template <std::size_t Slot>
+    void intern(const Atom& sub);
+
+    template <std::size_t Slot, typename... Args>
+    void intern(const Node<Args...>& sub);
+
+    template <std::size_t Slot, typename... Args, std::size_t... J>
+    void internArgs(const Node<Args...>& sub, std::index_sequence<J...>);
+
+    template <std::size_t Slot, std::size_t I>
+    bool matchAt(const Var<I>*, const Term<std::string>& t, Captures& captures) const;
+
+    template <std::size_t Slot>
+    bool matchAt(const Atom*, const Term<std::string>& t, Captures& captures) const;
+
+    template <std::size_t Slot, typename... Args>
+    bool matchAt(const Node<Args...>*, const Term<std::string>& t, Captures& captures) const;
+
+    template <std::size_t Slot, typename... Args, std::size_t... J>
+    bool matchArgs(const Compound<std::string>& comp,
+                   Captures& captures,
+                   std::index_sequence<J...>) const;
+};
+
+template <typename P>
+Compiled<P> compile(const P& pattern);
+
+// ------------------------- Inline Implementations ------------------------
+
+template <std::size_t I>
+inline constexpr Var<I> var() noexcept {
+    return {};
+}
+
+inline constexpr Atom atom(std::string_view text) noexcept {
+    return Atom{text};
+}
+
+template <typename... Args>
+inline constexpr Node<Args...> compound(std::string_view functor, Args... args) {
+    return Node<Args...>{functor, std::tuple<Args...>(args...)};
+}
+
+template <typename P>
+inline Compiled<P>::Compiled(const P& pattern) : symbols_{} {
+    intern<0>(pattern);
+}
+
+template <typename P>
+inline std::optional<typename Compiled<P>::Captures> Compiled<P>::match(
+    const Term<std::string>& subject) const {
+    Captures captures{};
+    if (!match(subject, captures)) {
+        return std::nullopt;
+    }
+    return captures;
+}
+
+template <typename P>
+inline bool Compiled<P>::match(const Term<std::string>& subject, Captures& captures) const {
+    captures.fill(nullptr);
+    return matchAt<0>(static_cast<const P*>(nullptr), subject, captures);
+}
+
+template <typename P>
+template <std::size_t Slot, std::size_t I>
+inline void Compiled<P>::intern(const Var<I>&) noexcept {}
+
+template <typename P>
+template <std::size_t Slot>
+inline void Compiled<P>::intern(const Atom& sub) {
+    symbols_[Slot] = SymbolRegistry::atom(sub.text);
+}
+
+template <typename P>
+template <std::size_t Slot, typename... Args>
+inline void Compiled<P>::intern(const Node<Args...>& sub) {
+    symbols_[Slot] = SymbolRegistry::atom(sub.functor);
+    internArgs<Slot, Args...>(sub, std::index_sequence_for<Args...>());
+}
+
+template <typename P>
+template <std::size_t Slot, typename... Args, std::size_t... J>
+inline void Compiled<P>::internArgs(const Node<Args...>& sub, std::index_sequence<J...>) {
+    (intern<detail::argSlot<Slot, J, Args...>()>(std::get<J>(sub.args)), ...);
+}
+
+template <typename P>
+template <std::size_t Slot, std::size_t I>
+inline bool Compiled<P>::matchAt(const Var<I>*,
+                                 const Term<std::string>& t,
+                                 Captures& captures) const {
+    if (captures[I] != nullptr) {
+        return identical(*captures[I], t);
+    }
+    captures[I] = &t;
+    return true;
+}
+
+template <typename P>
+template <std::size_t Slot>
+inline bool Compiled<P>::matchAt(const Atom*, const Term<std::string>& t, Captures&) const {
+    return t.isConstant() && termCast<Constant>(t).id() == symbols_[Slot];
+}
+
+template <typename P>
+template <std::size_t Slot, typename... Args>
+inline bool Compiled<P>::matchAt(const Node<Args...>*,
+                                 const Term<std::string>& t,
+                                 Captures& captures) const {
+    if (!t.isCompound()) {
+        return false;
+    }
+    const auto& comp = termCast<Compound<std::string>>(t);
+    if (comp.functorId() != symbols_[Slot] || comp.arity() != sizeof...(Args)) {
+        return false;
+    }
+    return matchArgs<Slot, Args...>(comp, captures, std::index_sequence_for<Args...>());
+}
+
+template <typename P>
+template <std::size_t Slot, typename... Args, std::size_t... J>
+inline bool Compiled<P>::matchArgs(const Compound<std::string>& comp,
+                                   Captures& captures,
+                                   std::index_sequence<J...>) const {
+    // left to right, stopping at the first mismatch
+    return (matchAt<detail::argSlot<Slot, J, Args...>()>(
+                static_cast<const Args*>(nullptr), comp.arg(J), captures) &&
+            ...);
+}
+
+template <typename P>
+inline Compiled<P> compile(const P& pattern) {
+    return Compiled<P>(pattern);
+}
+
+}  // namespace pattern
+
+#endif // TERM_PATTERN_H
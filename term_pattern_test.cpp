@@ -0,0 +1,92 @@
+#include <memory>
+#include <string>
+
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_pattern.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+namespace {
+
+using namespace pattern;
+
+const auto kEdge = compile(compound("edge", var<0>(), var<1>()));
+const auto kLoop = compile(compound("edge", var<0>(), var<0>()));
+const auto kLabelled = compile(compound("arc", atom("red"), compound("pair", var<1>(), var<0>())));
+const auto kAtom = compile(atom("nil"));
+const auto kAny = compile(var<0>());
+
+static_assert(symbolCount<decltype(compound("arc", atom("red"),
+                                            compound("pair", var<1>(), var<0>())))>() == 3);
+static_assert(variableCount<decltype(compound("f", var<2>(), atom("a")))>() == 3);
+
+}  // namespace
+
+void testCaptures() {
+    TermPtr edge = parseTerm("edge(a, g(X))");
+    auto captures = kEdge.match(*edge);
+    CHECK(captures.has_value());
+    if (captures) {
+        CHECK_EQ(formatTerm(*(*captures)[0]), "a");
+        CHECK_EQ(formatTerm(*(*captures)[1]), "g(X)");
+        // captures point into the subject
+        CHECK((*captures)[0] == &termCast<Compound<std::string>>(*edge).arg(0));
+    }
+
+    TermPtr arc = parseTerm("arc(red, pair(b, c))");
+    auto labelled = kLabelled.match(*arc);
+    CHECK(labelled.has_value());
+    if (labelled) {
+        CHECK_EQ(formatTerm(*(*labelled)[0]), "c");
+        CHECK_EQ(formatTerm(*(*labelled)[1]), "b");
+    }
+
+    TermPtr nil = parseTerm("nil");
+    CHECK(kAtom.match(*nil).has_value());
+    TermPtr any = parseTerm("f(Y)");
+    auto whole = kAny.match(*any);
+    CHECK(whole.has_value() && (*whole)[0] == any.get());
+}
+
+void testMismatches() {
+    const char* misses[] = {
+        "edge(a)", "edge(a, b, c)", "node(a, b)", "edge", "X",
+    };
+    for (const char* text : misses) {
+        TermPtr term = parseTerm(text);
+        CHECK(!kEdge.match(*term).has_value());
+    }
+    TermPtr blue = parseTerm("arc(blue, pair(b, c))");
+    CHECK(!kLabelled.match(*blue).has_value());
+    TermPtr flat = parseTerm("arc(red, b)");
+    CHECK(!kLabelled.match(*flat).has_value());
+    TermPtr other = parseTerm("nul");
+    CHECK(!kAtom.match(*other).has_value());
+    TermPtr compoundNil = parseTerm("nil(a)");
+    CHECK(!kAtom.match(*compoundNil).has_value());
+}
+
+// A repeated capture needs structurally identical subterms, as Unifier::match does.
+void testRepeatedCaptures() {
+    TermPtr same = parseTerm("edge(f(X, a), f(X, a))");
+    CHECK(kLoop.match(*same).has_value());
+    TermPtr differ = parseTerm("edge(f(X, a), f(Y, a))");
+    CHECK(!kLoop.match(*differ).has_value());
+
+    Unifier unifier;
+    TermPtr loop = parseTerm("edge(Z, Z)");
+    for (const char* text : {"edge(f(X, a), f(X, a))", "edge(f(X, a), f(Y, a))", "edge(b, c)"}) {
+        TermPtr subject = parseTerm(text);
+        CHECK_EQ(kLoop.match(*subject).has_value(), unifier.match(*loop, *subject).has_value());
+    }
+}
+
+int main() {
+    testCaptures();
+    testMismatches();
+    testRepeatedCaptures();
+    return testSummary();
+}
@@ -0,0 +1,236 @@
+#ifndef TERM_RENAME_H
+#define TERM_RENAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// Renaming apart by offset instead of by copy. A term is read under a generation: every
+// variable V in it stands for the variable (V, generation), so the same stored clause
+// used at generations 3 and 4 has two disjoint sets of variables without a single node
+// being copied or a single name being built. Generation 0 is the term as written.
+using Generation = std::uint32_t;
+
+// A term together with the generation its variables are read at.
+struct RenamedTerm {
+    const Term<std::string>* term;
+    Generation generation;
+};
+
+// -------------------------------- Renamer ---------------------------------
+// Hands out generations; renaming a term is taking the next one.
+class Renamer {
+public:
+    // Next unused generation (never 0).
+    Generation fresh() noexcept;
+
+    // term renamed apart from everything renamed before.
+    RenamedTerm rename(const Term<std::string>& term) noexcept;
+
+    // Makes generations count up from 1 again; only safe once no bindings made with
+    // the old ones are in use.
+    void reset() noexcept;
+
+private:
+    Generation next_ = 1;
+};
+
+// ---------------------------- RenamedBindings -----------------------------
+// Triangular bindings over renamed variables, the counterpart of Bindings: each
+// (variable, generation) maps to a renamed term that may mention bound variables, and
+// every bind is trailed so undoTo(mark()) restores an earlier state.
+// Storage is one open-addressing table keyed by (generation, variable ID), reused across
+// clear() calls, so binding does not allocate once the table has grown.
+class RenamedBindings {
+public:
+    // Trail position returned by mark().
+    using Mark = std::size_t;
+
+    RenamedBindings() = default;
+
+    // Direct binding of (var, generation), or nullptr when unbound.
+    const RenamedTerm* lookup(SymbolId var, Generation generation) const noexcept;
+
+    // Follows bindings from term until reaching a non-variable or an unbound variable.
+    RenamedTerm resolve(RenamedTerm term) const noexcept;
+
+    // Binds (var, generation), which must be unbound, to value.
+    void bind(SymbolId var, Generation generation, RenamedTerm value);
+
+    Mark mark() const noexcept;
+
+    // Removes every binding made since m was taken.
+    void undoTo(Mark m) noexcept;
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    // Drops all bindings in time proportional to their number, keeping the storage.
+    void clear() noexcept;
+
+private:
+    struct Slot {
+        std::uint64_t key;
+        RenamedTerm value;
+    };
+
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t{0};
+
+    std::vector<Slot> slots_;           // capacity is 0 or a power of two
+    std::vector<std::uint64_t> trail_;  // keys in bind order
+
+    static std::uint64_t keyOf(SymbolId var, Generation generation) noexcept;
+    std::size_t home(std::uint64_t key) const noexcept;
+    void grow();
+    void erase(std::uint64_t key) noexcept;
+};
+
+// ---------------------------- RenamingUnifier -----------------------------
+// Unification of renamed terms into RenamedBindings, with the same extend-or-roll-back
+// contract as Unifier::unify(t1, t2, bindings). Nothing is copied while unifying; terms
+// are only built when a caller asks for a result with toTerm() or answer().
+// Not thread-safe; use one RenamingUnifier per thread like Unifier.
+class RenamingUnifier {
+public:
+    // Deferred is treated as Full: every binding is checked as it is made.
+    explicit RenamingUnifier(OccursCheck policy = OccursCheck::Full) noexcept;
+
+    void setOccursCheck(OccursCheck policy) noexcept;
+    OccursCheck occursCheck() const noexcept;
+
+    // Extends bindings with the unifier of t1 and t2; on failure bindings are left as
+    // they were on entry.
+    bool unify(RenamedTerm t1, RenamedTerm t2, RenamedBindings& bindings);
+
+    // Head unification for resolution: head is a clause head renamed to a generation no
+    // binding mentions yet, and repeated lists (sorted) the variables occurring more than
+    // once in it. A head variable that occurs once cannot be inside the term it gets
+    // bound to as long as no binding made so far points into the head, so until then
+    // binding it skips the occurs check; binding one to a large goal argument then costs
+    // O(1) instead of a scan of the argument.
+    bool unifyHead(RenamedTerm goal,
+                   RenamedTerm head,
+                   const std::vector<SymbolId>& repeated,
+                   RenamedBindings& bindings);
+
+    // term with bindings applied. An unbound variable of generation 0 keeps its name;
+    // each one of a later generation becomes a fresh _N variable (see
+    // SymbolRegistry::freshVariable()), the same one wherever it occurs in the result.
+    std::unique_ptr<Term<std::string>> toTerm(RenamedTerm term,
+                                              const RenamedBindings& bindings) const;
+
+    // Applied binding of every bound variable of query read at generation, keyed by
+    // the variable's own name. Fresh variables are shared across the whole answer.
+    Unifier::Substitution answer(const Term<std::string>& query,
+                                 Generation generation,
+                                 const RenamedBindings& bindings) const;
+
+private:
+    OccursCheck occursCheck_;
+
+    // Work stacks reused across calls.
+    std::vector<std::pair<RenamedTerm, RenamedTerm>> pairs_;
+    mutable std::vector<RenamedTerm> scan_;
+    mutable TermCloner<RenamedTerm> cloner_;
+    // Fresh variable standing for each unbound (generation << 32 | variable ID) met by
+    // the current toTerm() or answer() call.
+    mutable std::unordered_map<std::uint64_t, SymbolRegistry::InternedSymbol> fresh_;
+
+    // toTerm() without forgetting the fresh variables of earlier calls.
+    std::unique_ptr<Term<std::string>> build(RenamedTerm term,
+                                             const RenamedBindings& bindings) const;
+
+    // unify() and unifyHead(); repeated is nullptr for unify().
+    bool unifyTerms(RenamedTerm t1,
+                    RenamedTerm t2,
+                    const std::vector<SymbolId>* repeated,
+                    RenamedBindings& bindings);
+
+    // True if (var, generation) occurs in term under bindings.
+    bool occurs(SymbolId var,
+                Generation generation,
+                RenamedTerm term,
+                const RenamedBindings& bindings) const;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline Generation Renamer::fresh() noexcept {
+    return next_++;
+}
+
+inline RenamedTerm Renamer::rename(const Term<std::string>& term) noexcept {
+    return RenamedTerm{&term, fresh()};
+}
+
+inline void Renamer::reset() noexcept {
+    next_ = 1;
+}
+
+inline std::uint64_t RenamedBindings::keyOf(SymbolId var, Generation generation) noexcept {
+    return static_cast<std::uint64_t>(generation) << 32 | var;
+}
+
+inline std::size_t RenamedBindings::home(std::uint64_t key) const noexcept {
+    const std::uint64_t h = key * 0x9e3779b97f4a7c15ULL;
+    return static_cast<std::size_t>(h ^ (h >> 32)) & (slots_.size() - 1);
+}
+
+inline const RenamedTerm* RenamedBindings::lookup(SymbolId var,
+                                                  Generation generation) const noexcept {
+    if (trail_.empty()) {
+        return nullptr;
+    }
+    const std::uint64_t key = keyOf(var, generation);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = home(key);; i = (i + 1) & mask) {
+        if (slots_[i].key == key) {
+            return &slots_[i].value;
+        }
+        if (slots_[i].key == kEmpty) {
+            return nullptr;
+        }
+    }
+}
+
+inline RenamedTerm RenamedBindings::resolve(RenamedTerm term) const noexcept {
+    while (term.term->isVariable()) {
+        const RenamedTerm* bound = lookup(termCast<Variable>(*term.term).id(), term.generation);
+        if (bound == nullptr) {
+            break;
+        }
+        term = *bound;
+    }
+    return term;
+}
+
+inline RenamedBindings::Mark RenamedBindings::mark() const noexcept {
+    return trail_.size();
+}
+
+inline std::size_t RenamedBindings::size() const noexcept {
+    return trail_.size();
+}
+
+inline bool RenamedBindings::empty() const noexcept {
+    return trail_.empty();
+}
+
+inline RenamingUnifier::RenamingUnifier(OccursCheck policy) noexcept : occursCheck_(policy) {}
+
+inline void RenamingUnifier::setOccursCheck(OccursCheck policy) noexcept {
+    occursCheck_ = policy;
+}
+
+inline OccursCheck RenamingUnifier::occursCheck() const noexcept {
+    return occursCheck_;
+}
+
+#endif // TERM_RENAME_H
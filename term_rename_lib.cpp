@@ -0,0 +1,235 @@
+#include "term_rename.h"
+
+#include <algorithm>
+
+// ---------------------------- RenamedBindings -----------------------------
+
+void RenamedBindings::bind(SymbolId var, Generation generation, RenamedTerm value) {
+    if ((trail_.size() + 1) * 2 > slots_.size()) {
+        grow();
+    }
+    const std::uint64_t key = keyOf(var, generation);
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t i = home(key);
+    while (slots_[i].key != kEmpty) {
+        i = (i + 1) & mask;
+    }
+    slots_[i] = Slot{key, value};
+    trail_.push_back(key);
+}
+
+void RenamedBindings::undoTo(Mark m) noexcept {
+    while (trail_.size() > m) {
+        erase(trail_.back());
+        trail_.pop_back();
+    }
+}
+
+void RenamedBindings::clear() noexcept {
+    undoTo(0);
+}
+
+void RenamedBindings::grow() {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(old.empty() ? 64 : old.size() * 2, Slot{kEmpty, RenamedTerm{nullptr, 0}});
+    const std::size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.key == kEmpty) {
+            continue;
+        }
+        std::size_t i = home(slot.key);
+        while (slots_[i].key != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = slot;
+    }
+}
+
+void RenamedBindings::erase(std::uint64_t key) noexcept {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t hole = home(key);
+    while (slots_[hole].key != key) {
+        hole = (hole + 1) & mask;
+    }
+    // backward-shift deletion: pull later entries of the probe run into the hole unless
+    // that would move them before their home slot
+    for (std::size_t next = (hole + 1) & mask; slots_[next].key != kEmpty;
+         next = (next + 1) & mask) {
+        const std::size_t want = home(slots_[next].key);
+        const bool movable = hole <= next ? (want <= hole || want > next)
+                                          : (want <= hole && want > next);
+        if (movable) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole].key = kEmpty;
+}
+
+// ---------------------------- RenamingUnifier -----------------------------
+
+bool RenamingUnifier::unify(RenamedTerm t1, RenamedTerm t2, RenamedBindings& bindings) {
+    return unifyTerms(t1, t2, nullptr, bindings);
+}
+
+bool RenamingUnifier::unifyHead(RenamedTerm goal,
+                                RenamedTerm head,
+                                const std::vector<SymbolId>& repeated,
+                                RenamedBindings& bindings) {
+    return unifyTerms(goal, head, &repeated, bindings);
+}
+
+bool RenamingUnifier::unifyTerms(RenamedTerm t1,
+                                 RenamedTerm t2,
+                                 const std::vector<SymbolId>* repeated,
+                                 RenamedBindings& bindings) {
+    // with repeated set, t2 is a head at a generation nothing else mentions yet
+    const RenamedBindings::Mark start = bindings.mark();
+    // whether a binding made since start points into the head's generation; after one,
+    // a goal subterm can lead back to a single-occurrence head variable
+    bool headReachable = false;
+    pairs_.clear();
+    pairs_.emplace_back(t1, t2);
+    while (!pairs_.empty()) {
+        auto [a, b] = pairs_.back();
+        pairs_.pop_back();
+        a = bindings.resolve(a);
+        b = bindings.resolve(b);
+        if (a.term == b.term && a.generation == b.generation) {
+            continue;
+        }
+
+        if (!a.term->isVariable() && b.term->isVariable()) {
+            std::swap(a, b);
+        }
+        if (a.term->isVariable()) {
+            const SymbolId id = termCast<Variable>(*a.term).id();
+            if (b.term->isVariable() && termCast<Variable>(*b.term).id() == id &&
+                b.generation == a.generation) {
+                continue;
+            }
+            const bool single = repeated != nullptr && !headReachable &&
+                                a.generation == t2.generation &&
+                                !std::binary_search(repeated->begin(), repeated->end(), id);
+            if (occursCheck_ != OccursCheck::None && !single &&
+                occurs(id, a.generation, b, bindings)) {
+                bindings.undoTo(start);
+                return false;
+            }
+            bindings.bind(id, a.generation, b);
+            headReachable = headReachable || b.generation == t2.generation;
+            continue;
+        }
+
+        bool same = a.term->kind() == b.term->kind();
+        if (same && a.term->isConstant()) {
+            same = termCast<Constant>(*a.term).id() == termCast<Constant>(*b.term).id();
+        } else if (same) {
+            const auto& ca = termCast<Compound<std::string>>(*a.term);
+            const auto& cb = termCast<Compound<std::string>>(*b.term);
+            same = ca.functorId() == cb.functorId() && ca.arity() == cb.arity();
+            for (std::size_t i = ca.arity(); same && i > 0; --i) {
+                pairs_.emplace_back(RenamedTerm{&ca.arg(i - 1), a.generation},
+                                    RenamedTerm{&cb.arg(i - 1), b.generation});
+            }
+        }
+        if (!same) {
+            bindings.undoTo(start);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RenamingUnifier::occurs(SymbolId var,
+                             Generation generation,
+                             RenamedTerm term,
+                             const RenamedBindings& bindings) const {
+    scan_.clear();
+    scan_.push_back(term);
+    while (!scan_.empty()) {
+        const RenamedTerm current = bindings.resolve(scan_.back());
+        scan_.pop_back();
+        if (current.term->isVariable()) {
+            if (termCast<Variable>(*current.term).id() == var &&
+                current.generation == generation) {
+                return true;
+            }
+        } else if (current.term->isCompound()) {
+            const auto& comp = termCast<Compound<std::string>>(*current.term);
+            for (std::size_t i = 0; i < comp.arity(); ++i) {
+                scan_.push_back(RenamedTerm{&comp.arg(i), current.generation});
+            }
+        }
+    }
+    return false;
+}
+
+std::unique_ptr<Term<std::string>> RenamingUnifier::toTerm(RenamedTerm term,
+                                                           const RenamedBindings& bindings) const {
+    fresh_.clear();
+    return build(term, bindings);
+}
+
+std::unique_ptr<Term<std::string>> RenamingUnifier::build(RenamedTerm term,
+                                                          const RenamedBindings& bindings) const {
+    return cloner_.build(term, [this, &bindings](RenamedTerm node, auto& step) {
+        const RenamedTerm current = bindings.resolve(node);
+        switch (current.term->kind()) {
+        case TermKind::Variable: {
+            const auto& var = termCast<Variable>(*current.term);
+            if (current.generation == 0) {
+                step.leaf(std::make_unique<Variable>(var));  // keeps its interned ID
+            } else {
+                const std::uint64_t key =
+                    static_cast<std::uint64_t>(current.generation) << 32 | var.id();
+                auto [it, added] = fresh_.try_emplace(key);
+                if (added) {
+                    it->second = SymbolRegistry::freshVariable();
+                }
+                step.leaf(std::make_unique<Variable>(it->second));
+            }
+            break;
+        }
+        case TermKind::Constant:
+            step.leaf(current.term->clone());
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(*current.term);
+            step.compound(comp);
+            for (std::size_t i = 0; i < comp.arity(); ++i) {
+                step.child(RenamedTerm{&comp.arg(i), current.generation});
+            }
+            break;
+        }
+        }
+    });
+}
+
+Unifier::Substitution RenamingUnifier::answer(const Term<std::string>& query,
+                                              Generation generation,
+                                              const RenamedBindings& bindings) const {
+    Unifier::Substitution out;
+    fresh_.clear();
+    std::vector<const Term<std::string>*> pending{&query};
+    while (!pending.empty()) {
+        const Term<std::string>& term = *pending.back();
+        pending.pop_back();
+        if (term.isCompound()) {
+            const auto& comp = termCast<Compound<std::string>>(term);
+            for (std::size_t i = comp.arity(); i > 0; --i) {
+                pending.push_back(&comp.arg(i - 1));
+            }
+            continue;
+        }
+        if (!term.isVariable()) {
+            continue;
+        }
+        const auto& var = termCast<Variable>(term);
+        if (out.count(var.name()) != 0 || bindings.lookup(var.id(), generation) == nullptr) {
+            continue;
+        }
+        out.emplace(var.name(), build(RenamedTerm{&term, generation}, bindings));
+    }
+    return out;
+}
@@ -0,0 +1,102 @@
+#include <memory>
+#include <string>
+
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_rename.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Two renamings of one term have disjoint variables: binding one leaves the other free.
+void testDisjointRenamings() {
+    TermPtr clause = parseTerm("p(X, f(Y), X)");
+    TermPtr ground = parseTerm("p(a, f(b), a)");
+    Renamer renamer;
+    const RenamedTerm first = renamer.rename(*clause);
+    const RenamedTerm second = renamer.rename(*clause);
+    CHECK(first.generation != second.generation);
+    CHECK(first.generation != 0 && second.generation != 0);
+
+    RenamingUnifier unifier;
+    RenamedBindings bindings;
+    CHECK(unifier.unify(first, RenamedTerm{ground.get(), 0}, bindings));
+    CHECK_EQ(bindings.size(), 2u);
+    CHECK_EQ(formatTerm(*unifier.toTerm(first, bindings)), "p(a, f(b), a)");
+    // the free renaming comes out with fresh variables that keep its sharing and parse back
+    TermPtr free = parseTerm(formatTerm(*unifier.toTerm(second, bindings)));
+    const auto& args = termCast<Compound<std::string>>(*free);
+    const std::string x = formatTerm(args.arg(0));
+    const std::string y = formatTerm(termCast<Compound<std::string>>(args.arg(1)).arg(0));
+    CHECK(x != "X" && y != "Y" && x != y);
+    CHECK_EQ(formatTerm(*free), "p(" + x + ", f(" + y + "), " + x + ")");
+    Unifier plain;
+    CHECK(plain.unify(*free, *parseTerm("p(c, f(d), c)")).has_value());
+
+    // the two renamings unify with each other only through fresh bindings
+    TermPtr other = parseTerm("p(c, f(c), c)");
+    CHECK(unifier.unify(second, RenamedTerm{other.get(), 0}, bindings));
+    CHECK_EQ(formatTerm(*unifier.toTerm(first, bindings)), "p(a, f(b), a)");
+    CHECK_EQ(formatTerm(*unifier.toTerm(second, bindings)), "p(c, f(c), c)");
+
+    // the term as written (generation 0) is untouched by both
+    CHECK_EQ(formatTerm(*unifier.toTerm(RenamedTerm{clause.get(), 0}, bindings)),
+             "p(X, f(Y), X)");
+    TermPtr clash = parseTerm("p(X, f(X), X)");
+    CHECK(!unifier.unify(first, RenamedTerm{clash.get(), 0}, bindings));
+    CHECK_EQ(bindings.size(), 4u);
+}
+
+// An answer names each free variable of the clause once, across all its bindings.
+void testAnswer() {
+    TermPtr query = parseTerm("q(A, B, C)");
+    TermPtr clause = parseTerm("q(f(Z), Z, W)");
+    Renamer renamer;
+    RenamingUnifier unifier;
+    RenamedBindings bindings;
+    CHECK(unifier.unify(RenamedTerm{query.get(), 0}, renamer.rename(*clause), bindings));
+    const Unifier::Substitution answer = unifier.answer(*query, 0, bindings);
+    CHECK_EQ(answer.size(), 3u);
+    if (answer.size() == 3) {
+        const std::string z = formatTerm(*answer.at("B"));
+        CHECK_EQ(formatTerm(*answer.at("A")), "f(" + z + ")");
+        CHECK(formatTerm(*answer.at("C")) != z);
+        CHECK(formatTerm(*answer.at("C")) != "W");
+    }
+}
+
+// Undoing to a mark removes exactly the later bindings, across table growth.
+void testUndo() {
+    TermPtr x = parseTerm("X");
+    TermPtr a = parseTerm("a");
+    const SymbolId id = termCast<Variable>(*x).id();
+    RenamedBindings bindings;
+    for (Generation g = 1; g <= 50; ++g) {
+        bindings.bind(id, g, RenamedTerm{a.get(), 0});
+    }
+    const RenamedBindings::Mark mark = bindings.mark();
+    for (Generation g = 51; g <= 500; ++g) {
+        bindings.bind(id, g, RenamedTerm{x.get(), g - 1});
+    }
+    CHECK(bindings.resolve(RenamedTerm{x.get(), 500}).term == a.get());
+    bindings.undoTo(mark);
+    CHECK_EQ(bindings.size(), 50u);
+    bool kept = true;
+    for (Generation g = 1; g <= 50; ++g) {
+        kept = kept && bindings.lookup(id, g) != nullptr;
+    }
+    CHECK(kept);
+    CHECK(bindings.lookup(id, 51) == nullptr);
+    CHECK(bindings.lookup(id, 0) == nullptr);
+    bindings.clear();
+    CHECK(bindings.empty());
+    CHECK(bindings.lookup(id, 1) == nullptr);
+}
+
+int main() {
+    testDisjointRenamings();
+    testAnswer();
+    testUndo();
+    return testSummary();
+}
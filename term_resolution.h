@@ -0,0 +1,280 @@
+#ifndef TERM_RESOLUTION_H
+#define TERM_RESOLUTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "term_index.h"
+#include "term_rename.h"
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// ------------------------------- ClauseStore ------------------------------
+// Program clauses Head :- Goal1, ..., GoalN (facts have no goals). Heads are indexed in a
+// DiscriminationTree, so resolving a goal only tries clauses whose head may unify with
+// it. A clause's head and body share variables by name and are renamed apart as a whole.
+class ClauseStore {
+public:
+    using ClauseId = DiscriminationTree::EntryId;
+
+    ClauseStore() = default;
+    ClauseStore(const ClauseStore&) = delete;
+    ClauseStore& operator=(const ClauseStore&) = delete;
+
+    // Adds head :- body; IDs count up from 0 in insertion order.
+    ClauseId add(std::unique_ptr<Term<std::string>> head,
+                 std::vector<std::unique_ptr<Term<std::string>>> body);
+
+    // Adds a clause as parsed: ':-'(Head, Goal1, ..., GoalN) is a rule, anything else a
+    // fact. Throws std::invalid_argument for a variable or a ':-' without a head.
+    ClauseId add(std::unique_ptr<Term<std::string>> clause);
+
+    const Term<std::string>& head(ClauseId id) const;
+    const std::vector<std::unique_ptr<Term<std::string>>>& body(ClauseId id) const;
+    std::size_t size() const noexcept;
+
+    // IDs of the variables occurring more than once in the head, sorted (see
+    // RenamingUnifier::unifyHead).
+    const std::vector<SymbolId>& repeatedHeadVariables(ClauseId id) const;
+
+    // Clauses whose head may unify with goal, in insertion order. Variables of goal are
+    // wildcards, so passing a goal whose variables are bound elsewhere loses precision
+    // but never an answer.
+    std::vector<ClauseId> candidates(const Term<std::string>& goal) const;
+
+private:
+    DiscriminationTree heads_;
+    std::vector<std::vector<std::unique_ptr<Term<std::string>>>> bodies_;  // by clause ID
+    std::vector<std::vector<SymbolId>> repeated_;                          // by clause ID
+};
+
+// --------------------------------- Solver ---------------------------------
+// SLD resolution over a ClauseStore: leftmost goal first, clauses in insertion order,
+// depth-first with chronological backtracking and no cut.
+// The driver is a loop over an explicit goal list and choice-point stack, never a
+// recursive call, so proof depth is limited by memory only. Bindings live in one
+// RenamedBindings, and each choice point is just a trail mark: backtracking undoes
+// bindings instead of restoring copied substitutions. Clauses are renamed apart by
+// generation (see term_rename.h), so trying a clause copies nothing; only answers are
+// built as terms.
+// Not thread-safe; share the ClauseStore (read-only) and use one Solver per thread.
+class Solver {
+public:
+    // Called once per answer with the bindings of the query's variables; return false to
+    // stop the search.
+    using AnswerFn = std::function<bool(const Unifier::Substitution&)>;
+
+    class Answers;
+
+    // clauses must outlive the Solver.
+    explicit Solver(const ClauseStore& clauses, OccursCheck policy = OccursCheck::Full);
+    Solver(const Solver&) = delete;
+    Solver& operator=(const Solver&) = delete;
+
+    // Branches whose goals are nested deeper than depth resolution steps fail instead of
+    // going on; 0 (the default) means no limit. A limit makes left-recursive programs
+    // terminate, at the cost of the answers beyond it.
+    void setDepthLimit(std::size_t depth) noexcept;
+    std::size_t depthLimit() const noexcept;
+
+    // Starts proving goal and returns its answers as a lazy sequence: the search only
+    // runs as far as the next answer each time one is asked for, so a caller wanting the
+    // first answer pays for that proof alone. The goals must outlive the sequence, and
+    // starting another query on this Solver invalidates it.
+    // Throws std::invalid_argument (while advancing) if a goal to be resolved is an
+    // unbound variable.
+    Answers query(const Term<std::string>& goal);
+    Answers query(const std::vector<const Term<std::string>*>& goals);
+
+    // Proves goal, reporting each answer to onAnswer; returns the number reported.
+    // Throws std::invalid_argument if a goal to be resolved is an unbound variable.
+    std::size_t solve(const Term<std::string>& goal, const AnswerFn& onAnswer);
+
+    // Same for the conjunction of goals (proved left to right).
+    std::size_t solve(const std::vector<const Term<std::string>*>& goals,
+                      const AnswerFn& onAnswer);
+
+    // Up to limit answers of goal, in search order.
+    std::vector<Unifier::Substitution> solveAll(
+        const Term<std::string>& goal,
+        std::size_t limit = std::numeric_limits<std::size_t>::max());
+
+    // Head unifications attempted by the last (or current) query.
+    std::size_t inferences() const noexcept;
+
+private:
+    static constexpr std::uint32_t kNoGoal = static_cast<std::uint32_t>(-1);
+
+    // Goal-list cell. Lists share their tails, so a choice point only needs the index of
+    // its list; cells made after it are dropped by truncation on backtracking.
+    struct GoalNode {
+        RenamedTerm goal;
+        std::uint32_t next;   // rest of the list, or kNoGoal
+        std::uint32_t depth;  // resolution steps that led to this goal
+    };
+
+    // Alternatives left for the first goal of list goal: candidates_[next .. end).
+    struct Choice {
+        std::uint32_t goal;
+        RenamedBindings::Mark mark;
+        std::size_t goalCount;  // goals_.size() when made
+        std::size_t begin;      // first of its candidates in candidates_
+        std::size_t next;
+        std::size_t end;
+    };
+
+    const ClauseStore& clauses_;
+    RenamingUnifier unifier_;
+    RenamedBindings bindings_;
+    Renamer renamer_;
+    std::size_t depthLimit_ = 0;
+    std::size_t inferences_ = 0;
+    std::size_t queries_ = 0;  // queries started, so a stale Answers can tell
+
+    // Search state of the current query; start() resets it and advance() resumes it.
+    std::vector<const Term<std::string>*> query_;
+    std::vector<GoalNode> goals_;
+    std::vector<Choice> choices_;
+    std::vector<ClauseStore::ClauseId> candidates_;
+    std::uint32_t current_ = kNoGoal;  // goal list still to prove
+    bool answered_ = false;            // current_ is a reported answer, to backtrack from
+    bool exhausted_ = false;           // no alternatives left
+
+    void start(const std::vector<const Term<std::string>*>& goals);
+
+    // Runs until the next answer (true) or until the search space is exhausted (false).
+    bool advance();
+
+    // Bindings of the query's variables at the current answer.
+    Unifier::Substitution answer() const;
+
+    // Tries the remaining alternatives of the top choice point, popping it once none
+    // are left; true when one resolved and current_ is the new goal list.
+    bool resume();
+
+    // Undoes to the latest choice point that still has an alternative and resolves it.
+    bool backtrack();
+};
+
+// ---------------------------- Solver::Answers -----------------------------
+// Single-pass sequence of the answers of one query, each computed when asked for.
+//     for (Unifier::Substitution& answer : solver.query(goal)) { ... break; }
+class Solver::Answers {
+public:
+    class iterator {
+    public:
+        using value_type = Unifier::Substitution;
+        using reference = Unifier::Substitution&;
+        using pointer = Unifier::Substitution*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+
+        Unifier::Substitution& operator*() const noexcept;
+        Unifier::Substitution* operator->() const noexcept;
+        iterator& operator++();
+        bool operator==(const iterator& other) const noexcept;
+        bool operator!=(const iterator& other) const noexcept;
+
+    private:
+        friend class Answers;
+
+        explicit iterator(Answers* owner) noexcept;
+
+        Answers* owner_;  // nullptr at the end
+    };
+
+    // Next answer, or std::nullopt once the search space is exhausted. Throws
+    // std::logic_error if the Solver has started another query since.
+    std::optional<Unifier::Substitution> next();
+
+    // Iteration over the answers not taken yet; begin() computes the first of them.
+    iterator begin();
+    iterator end() noexcept;
+
+private:
+    friend class Solver;
+
+    Answers(Solver& solver, std::size_t query) noexcept;
+
+    Solver* solver_;
+    std::size_t query_;                            // the Solver's query it belongs to
+    std::optional<Unifier::Substitution> current_;  // the answer an iterator points at
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline std::size_t ClauseStore::size() const noexcept {
+    return bodies_.size();
+}
+
+inline std::vector<ClauseStore::ClauseId> ClauseStore::candidates(
+    const Term<std::string>& goal) const {
+    return heads_.unifiableCandidates(goal);
+}
+
+inline void Solver::setDepthLimit(std::size_t depth) noexcept {
+    depthLimit_ = depth;
+}
+
+inline std::size_t Solver::depthLimit() const noexcept {
+    return depthLimit_;
+}
+
+inline std::size_t Solver::inferences() const noexcept {
+    return inferences_;
+}
+
+inline std::size_t Solver::solve(const Term<std::string>& goal, const AnswerFn& onAnswer) {
+    return solve(std::vector<const Term<std::string>*>{&goal}, onAnswer);
+}
+
+inline Solver::Answers Solver::query(const Term<std::string>& goal) {
+    return query(std::vector<const Term<std::string>*>{&goal});
+}
+
+inline Solver::Answers::Answers(Solver& solver, std::size_t query) noexcept
+    : solver_(&solver), query_(query) {}
+
+inline Solver::Answers::iterator Solver::Answers::begin() {
+    current_ = next();
+    return iterator(current_ ? this : nullptr);
+}
+
+inline Solver::Answers::iterator Solver::Answers::end() noexcept {
+    return iterator(nullptr);
+}
+
+inline Solver::Answers::iterator::iterator(Answers* owner) noexcept : owner_(owner) {}
+
+inline Unifier::Substitution& Solver::Answers::iterator::operator*() const noexcept {
+    return *owner_->current_;
+}
+
+inline Unifier::Substitution* Solver::Answers::iterator::operator->() const noexcept {
+    return &*owner_->current_;
+}
+
+inline Solver::Answers::iterator& Solver::Answers::iterator::operator++() {
+    owner_->current_ = owner_->next();
+    if (!owner_->current_) {
+        owner_ = nullptr;
+    }
+    return *this;
+}
+
+inline bool Solver::Answers::iterator::operator==(const iterator& other) const noexcept {
+    return owner_ == other.owner_;
+}
+
+inline bool Solver::Answers::iterator::operator!=(const iterator& other) const noexcept {
+    return owner_ != other.owner_;
+}
+
+#endif // TERM_RESOLUTION_H
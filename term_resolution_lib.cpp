@@ -0,0 +1,246 @@
+#include "term_resolution.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+// ------------------------------- ClauseStore ------------------------------
+
+ClauseStore::ClauseId ClauseStore::add(std::unique_ptr<Term<std::string>> head,
+                                       std::vector<std::unique_ptr<Term<std::string>>> body) {
+    if (head->isVariable()) {
+        throw std::invalid_argument("ClauseStore::add: clause head is a variable");
+    }
+    // variables by number of occurrences in the head
+    std::vector<std::pair<SymbolId, std::size_t>> counts;
+    std::vector<const Term<std::string>*> pending{head.get()};
+    while (!pending.empty()) {
+        const Term<std::string>& term = *pending.back();
+        pending.pop_back();
+        if (term.isVariable()) {
+            const SymbolId var = termCast<Variable>(term).id();
+            auto it = std::find_if(counts.begin(), counts.end(),
+                                   [var](const auto& entry) { return entry.first == var; });
+            if (it == counts.end()) {
+                counts.emplace_back(var, 1);
+            } else {
+                ++it->second;
+            }
+        } else if (term.isCompound()) {
+            const auto& comp = termCast<Compound<std::string>>(term);
+            for (std::size_t i = 0; i < comp.arity(); ++i) {
+                pending.push_back(&comp.arg(i));
+            }
+        }
+    }
+    std::vector<SymbolId> repeated;
+    for (const auto& [var, count] : counts) {
+        if (count > 1) {
+            repeated.push_back(var);
+        }
+    }
+    std::sort(repeated.begin(), repeated.end());
+
+    const ClauseId id = heads_.insert(std::move(head));
+    bodies_.push_back(std::move(body));
+    repeated_.push_back(std::move(repeated));
+    return id;
+}
+
+ClauseStore::ClauseId ClauseStore::add(std::unique_ptr<Term<std::string>> clause) {
+    if (!clause->isCompound() || termCast<Compound<std::string>>(*clause).functor() != ":-") {
+        return add(std::move(clause), {});
+    }
+    const auto& rule = termCast<Compound<std::string>>(*clause);
+    if (rule.arity() == 0) {
+        throw std::invalid_argument("ClauseStore::add: ':-' without a head");
+    }
+    std::unique_ptr<Term<std::string>> head = rule.arg(0).clone();
+    std::vector<std::unique_ptr<Term<std::string>>> body;
+    body.reserve(rule.arity() - 1);
+    for (std::size_t i = 1; i < rule.arity(); ++i) {
+        body.push_back(rule.arg(i).clone());
+    }
+    return add(std::move(head), std::move(body));
+}
+
+const Term<std::string>& ClauseStore::head(ClauseId id) const {
+    return heads_.term(id);
+}
+
+const std::vector<std::unique_ptr<Term<std::string>>>& ClauseStore::body(ClauseId id) const {
+    return bodies_.at(id);
+}
+
+const std::vector<SymbolId>& ClauseStore::repeatedHeadVariables(ClauseId id) const {
+    return repeated_.at(id);
+}
+
+// --------------------------------- Solver ---------------------------------
+
+Solver::Solver(const ClauseStore& clauses, OccursCheck policy)
+    : clauses_(clauses), unifier_(policy) {}
+
+Solver::Answers Solver::query(const std::vector<const Term<std::string>*>& goals) {
+    start(goals);
+    return Answers(*this, queries_);
+}
+
+std::size_t Solver::solve(const std::vector<const Term<std::string>*>& goals,
+                          const AnswerFn& onAnswer) {
+    Answers answers = query(goals);
+    std::size_t count = 0;
+    while (auto sub = answers.next()) {
+        ++count;
+        if (!onAnswer(*sub)) {
+            break;
+        }
+    }
+    return count;
+}
+
+std::vector<Unifier::Substitution> Solver::solveAll(const Term<std::string>& goal,
+                                                    std::size_t limit) {
+    std::vector<Unifier::Substitution> out;
+    if (limit == 0) {
+        return out;
+    }
+    Answers answers = query(goal);
+    while (out.size() < limit) {
+        auto sub = answers.next();
+        if (!sub) {
+            break;
+        }
+        out.push_back(std::move(*sub));
+    }
+    return out;
+}
+
+void Solver::start(const std::vector<const Term<std::string>*>& goals) {
+    bindings_.clear();
+    renamer_.reset();
+    goals_.clear();
+    choices_.clear();
+    candidates_.clear();
+    inferences_ = 0;
+    answered_ = false;
+    exhausted_ = false;
+    query_ = goals;
+    ++queries_;
+
+    // the query is read at generation 0, so its variables keep their names in answers
+    current_ = kNoGoal;
+    for (std::size_t i = goals.size(); i > 0; --i) {
+        goals_.push_back(GoalNode{RenamedTerm{goals[i - 1], 0}, current_, 0});
+        current_ = static_cast<std::uint32_t>(goals_.size() - 1);
+    }
+}
+
+bool Solver::advance() {
+    if (exhausted_) {
+        return false;
+    }
+    if (answered_) {
+        answered_ = false;
+        if (!backtrack()) {
+            return false;
+        }
+    }
+    for (;;) {
+        if (current_ == kNoGoal) {
+            answered_ = true;
+            return true;
+        }
+        const GoalNode& node = goals_[current_];
+        if (depthLimit_ != 0 && node.depth >= depthLimit_) {
+            if (!backtrack()) {
+                return false;
+            }
+            continue;
+        }
+        const RenamedTerm goal = bindings_.resolve(node.goal);
+        if (goal.term->isVariable()) {
+            throw std::invalid_argument("Solver: goal is an unbound variable");
+        }
+
+        const std::size_t begin = candidates_.size();
+        const std::vector<ClauseStore::ClauseId> found = clauses_.candidates(*goal.term);
+        candidates_.insert(candidates_.end(), found.begin(), found.end());
+        choices_.push_back(
+            Choice{current_, bindings_.mark(), goals_.size(), begin, begin, candidates_.size()});
+        if (!resume() && !backtrack()) {
+            return false;
+        }
+    }
+}
+
+Unifier::Substitution Solver::answer() const {
+    Unifier::Substitution out;
+    for (const Term<std::string>* goal : query_) {
+        Unifier::Substitution part = unifier_.answer(*goal, 0, bindings_);
+        out.merge(part);
+    }
+    return out;
+}
+
+bool Solver::resume() {
+    Choice& choice = choices_.back();
+    const GoalNode node = goals_[choice.goal];
+    const RenamedTerm goal = bindings_.resolve(node.goal);
+    while (choice.next < choice.end) {
+        const ClauseStore::ClauseId id = candidates_[choice.next++];
+        const Generation generation = renamer_.fresh();
+        ++inferences_;
+        if (!unifier_.unifyHead(goal, RenamedTerm{&clauses_.head(id), generation},
+                                clauses_.repeatedHeadVariables(id), bindings_)) {
+            continue;
+        }
+
+        // the clause body, renamed with its head, goes in front of the remaining goals
+        std::uint32_t list = node.next;
+        const auto& body = clauses_.body(id);
+        for (std::size_t i = body.size(); i > 0; --i) {
+            goals_.push_back(GoalNode{RenamedTerm{body[i - 1].get(), generation}, list,
+                                      node.depth + 1});
+            list = static_cast<std::uint32_t>(goals_.size() - 1);
+        }
+        current_ = list;
+
+        if (choice.next == choice.end) {
+            // last alternative: nothing to come back to, so drop the choice point now
+            candidates_.resize(choice.begin);
+            choices_.pop_back();
+        }
+        return true;
+    }
+    candidates_.resize(choice.begin);
+    choices_.pop_back();
+    return false;
+}
+
+bool Solver::backtrack() {
+    while (!choices_.empty()) {
+        const Choice& choice = choices_.back();
+        bindings_.undoTo(choice.mark);
+        goals_.resize(choice.goalCount);
+        candidates_.resize(choice.end);
+        if (resume()) {
+            return true;
+        }
+    }
+    current_ = kNoGoal;
+    exhausted_ = true;
+    return false;
+}
+
+// ---------------------------- Solver::Answers -----------------------------
+
+std::optional<Unifier::Substitution> Solver::Answers::next() {
+    if (solver_->queries_ != query_) {
+        throw std::logic_error("Solver::Answers: the solver has started another query");
+    }
+    if (!solver_->advance()) {
+        return std::nullopt;
+    }
+    return solver_->answer();
+}
@@ -0,0 +1,156 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_rename.h"
+#include "term_resolution.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Adds every clause of text to store.
+void load(ClauseStore& store, const std::string& text) {
+    for (TermPtr& clause : parseClauses(text)) {
+        store.add(std::move(clause));
+    }
+}
+
+// Formatted answers of query, one substitution each.
+std::vector<std::string> answers(Solver& solver, const std::string& query) {
+    TermPtr goal = parseTerm(query);
+    std::vector<std::string> out;
+    for (const Unifier::Substitution& answer : solver.solveAll(*goal)) {
+        out.push_back(formatSubstitution(answer));
+    }
+    return out;
+}
+
+// Skipping the occurs check for a head variable that occurs once is only sound until a
+// binding points into the head: here V gets bound after Y -> V, to g(Y).
+void testHeadOccursCheck() {
+    RenamingUnifier unifier;
+    RenamedBindings bindings;
+    Renamer renamer;
+    TermPtr goal = parseTerm("f(g(Y), Y, Y)");
+    TermPtr head = parseTerm("f(U, V, U)");
+    const std::vector<SymbolId> repeated{termCast<Variable>(
+        termCast<Compound<std::string>>(*head).arg(0)).id()};
+    CHECK(!unifier.unifyHead(RenamedTerm{goal.get(), 0}, renamer.rename(*head), repeated,
+                             bindings));
+    CHECK(bindings.empty());
+
+    ClauseStore store;
+    load(store, "p(U, V, U). q(W, W).");
+    Solver solver(store);
+    CHECK(answers(solver, "p(g(Y), Y, Y)").empty());
+    CHECK(answers(solver, "q(Y, f(Y))").empty());
+    CHECK(answers(solver, "p(g(Y), Y, g(Z))").size() == 1u);
+    CHECK(answers(solver, "p(g(a), a, Y)") == std::vector<std::string>{"Y -> g(a)"});
+}
+
+// Leftmost goal first, clauses in insertion order, depth first.
+void testSearchOrder() {
+    ClauseStore store;
+    load(store,
+         "edge(a, b). edge(a, c). edge(b, d).\n"
+         "':-'(path(X, Y), edge(X, Y)).\n"
+         "':-'(path(X, Y), edge(X, Z), path(Z, Y)).\n");
+    Solver solver(store);
+    CHECK(answers(solver, "path(a, W)") ==
+          (std::vector<std::string>{"W -> b", "W -> c", "W -> d"}));
+    CHECK(answers(solver, "path(W, d)") == (std::vector<std::string>{"W -> b", "W -> a"}));
+    CHECK(answers(solver, "path(d, W)").empty());
+
+    TermPtr edge = parseTerm("edge(a, W)");
+    TermPtr path = parseTerm("path(W, V)");
+    std::vector<std::string> pairs;
+    solver.solve({edge.get(), path.get()}, [&pairs](const Unifier::Substitution& answer) {
+        pairs.push_back(formatSubstitution(answer));
+        return true;
+    });
+    CHECK(pairs == (std::vector<std::string>{"V -> d, W -> b"}));
+
+    TermPtr unbound = parseTerm("W");
+    CHECK_THROWS(solver.solveAll(*unbound), std::invalid_argument);
+}
+
+// A depth limit cuts off infinite branches, keeping the answers found above it.
+void testDepthLimit() {
+    ClauseStore store;
+    load(store, "nat(z). ':-'(nat(s(X)), nat(X)).");
+    Solver solver(store);
+    CHECK_EQ(solver.depthLimit(), 0u);
+    TermPtr nat = parseTerm("nat(N)");
+    CHECK_EQ(solver.solveAll(*nat, 3).size(), 3u);
+
+    // at most two resolution steps per branch
+    solver.setDepthLimit(2);
+    CHECK(answers(solver, "nat(N)") == (std::vector<std::string>{"N -> z", "N -> s(z)"}));
+    CHECK_EQ(answers(solver, "nat(s(z))").size(), 1u);
+    CHECK(answers(solver, "nat(s(s(z)))").empty());
+
+    ClauseStore left;
+    load(left, "':-'(anc(X, Y), anc(X, Z), parent(Z, Y)). ':-'(anc(X, Y), parent(X, Y)). "
+               "parent(a, b). parent(b, c).");
+    Solver bounded(left);
+    bounded.setDepthLimit(4);
+    CHECK(answers(bounded, "anc(a, W)") == (std::vector<std::string>{"W -> c", "W -> b"}));
+}
+
+// Answers are computed one at a time, so taking a few of infinitely many terminates.
+void testLazyAnswers() {
+    ClauseStore store;
+    load(store, "nat(z). ':-'(nat(s(X)), nat(X)).");
+    Solver solver(store);
+    TermPtr nat = parseTerm("nat(N)");
+
+    Solver::Answers answers = solver.query(*nat);
+    auto first = answers.next();
+    CHECK(first.has_value());
+    if (first) {
+        CHECK_EQ(formatSubstitution(*first), "N -> z");
+    }
+    CHECK_EQ(solver.inferences(), 1u);
+    auto second = answers.next();
+    CHECK(second.has_value());
+    if (second) {
+        CHECK_EQ(formatSubstitution(*second), "N -> s(z)");
+    }
+
+    std::vector<std::string> taken;
+    for (Unifier::Substitution& answer : solver.query(*nat)) {
+        taken.push_back(formatSubstitution(answer));
+        if (taken.size() == 3) {
+            break;
+        }
+    }
+    CHECK(taken == (std::vector<std::string>{"N -> z", "N -> s(z)", "N -> s(s(z))"}));
+
+    // the first sequence belongs to an earlier query now
+    CHECK_THROWS(answers.next(), std::logic_error);
+
+    std::size_t seen = 0;
+    const std::size_t reported = solver.solve(*nat, [&seen](const Unifier::Substitution&) {
+        return ++seen < 4;
+    });
+    CHECK_EQ(reported, 4u);
+    CHECK_EQ(seen, 4u);
+
+    TermPtr done = parseTerm("nat(s(z))");
+    Solver::Answers one = solver.query(*done);
+    CHECK(one.next().has_value());
+    CHECK(!one.next().has_value());
+    CHECK(!one.next().has_value());
+}
+
+int main() {
+    testHeadOccursCheck();
+    testSearchOrder();
+    testDepthLimit();
+    testLazyAnswers();
+    return testSummary();
+}
@@ -0,0 +1,124 @@
+#ifndef TERM_SHARED_H
+#define TERM_SHARED_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "term_database.h"
+#include "term_unification.h"
+
+// ------------------------------ TermSnapshot ------------------------------
+// Immutable state of a SharedTermDatabase: its facts as a list of segments, each an
+// indexed TermDatabase that is never modified once published. Any number of threads may
+// query one snapshot at the same time without synchronization, and a snapshot stays
+// valid (and unchanged) for as long as someone holds it, whatever the writer does.
+// Fact IDs are global across segments and count up from 0 in publication order.
+class TermSnapshot {
+public:
+    using FactId = TermDatabase::FactId;
+    using Match = TermDatabase::Match;
+
+    // One published batch of facts; facts holds IDs base .. base + facts.size().
+    struct Segment {
+        FactId base;
+        TermDatabase facts;
+    };
+
+    // Lazy matches of one goal across all segments, like TermDatabase::Matches. goal,
+    // unifier and the snapshot must outlive it.
+    class Matches {
+    public:
+        // Next match, or std::nullopt once every segment is used up.
+        std::optional<Match> next();
+
+    private:
+        friend class TermSnapshot;
+
+        Matches(const TermSnapshot& snapshot, const Term<std::string>& goal,
+                Unifier& unifier);
+
+        const TermSnapshot* snapshot_;
+        const Term<std::string>* goal_;
+        Unifier* unifier_;
+        std::size_t segment_ = 0;                    // segment current_ belongs to
+        std::optional<TermDatabase::Matches> current_;
+    };
+
+    TermSnapshot() = default;
+    explicit TermSnapshot(std::vector<std::shared_ptr<const Segment>> segments);
+    TermSnapshot(const TermSnapshot&) = delete;
+    TermSnapshot& operator=(const TermSnapshot&) = delete;
+
+    // Throws std::out_of_range for an ID not in this snapshot.
+    const Compound<std::string>& fact(FactId id) const;
+    std::size_t size() const noexcept;
+
+    // Same contracts as TermDatabase's, with global IDs.
+    std::vector<FactId> candidates(const Term<std::string>& goal) const;
+    std::vector<Match> query(const Term<std::string>& goal, Unifier& unifier) const;
+    Matches matches(const Term<std::string>& goal, Unifier& unifier) const;
+
+    const std::vector<std::shared_ptr<const Segment>>& segments() const noexcept;
+
+private:
+    std::vector<std::shared_ptr<const Segment>> segments_;
+    std::size_t size_ = 0;
+};
+
+// --------------------------- SharedTermDatabase ---------------------------
+// Fact base shared by many threads: readers take the current TermSnapshot and query it
+// with no locks held, while a writer appends facts in batches. Publication is RCU-style:
+// the writer builds the new segment and a new segment list off to the side, then swaps
+// the published shared_ptr atomically. Readers never wait for a writer and never see a
+// half-added batch, and a reader holding an old snapshot keeps it alive until it lets go.
+// Segments are shared between consecutive snapshots, so publishing a batch copies no
+// facts; to keep queries from visiting many small segments, a batch that leaves the
+// newest segment at least as large as the one before merges the two (like carrying in a
+// binary counter), which keeps the count logarithmic in the number of facts and copies
+// each fact O(log n) times overall.
+// Writers are serialized with a mutex; snapshot() is safe to call from any thread.
+class SharedTermDatabase {
+public:
+    using FactId = TermSnapshot::FactId;
+
+    SharedTermDatabase();
+    SharedTermDatabase(const SharedTermDatabase&) = delete;
+    SharedTermDatabase& operator=(const SharedTermDatabase&) = delete;
+
+    // The current state; hold on to it for a consistent view across several queries.
+    std::shared_ptr<const TermSnapshot> snapshot() const;
+
+    // Appends facts as one batch and returns the ID of its first fact; the batch becomes
+    // visible to snapshot() all at once. Throws std::invalid_argument for a null fact,
+    // in which case nothing is published.
+    FactId publish(std::vector<std::unique_ptr<Compound<std::string>>> facts);
+
+    // Appends a single fact (a batch of one).
+    FactId add(std::unique_ptr<Compound<std::string>> fact);
+
+private:
+    std::shared_ptr<const TermSnapshot> current_;  // only accessed through std::atomic_*
+    std::mutex writer_;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline std::size_t TermSnapshot::size() const noexcept {
+    return size_;
+}
+
+inline const std::vector<std::shared_ptr<const TermSnapshot::Segment>>& TermSnapshot::segments()
+    const noexcept {
+    return segments_;
+}
+
+inline TermSnapshot::Matches TermSnapshot::matches(const Term<std::string>& goal,
+                                                   Unifier& unifier) const {
+    return Matches(*this, goal, unifier);
+}
+
+#endif // TERM_SHARED_H
@@ -0,0 +1,125 @@
+#include "term_shared.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+// ------------------------------ TermSnapshot ------------------------------
+
+TermSnapshot::TermSnapshot(std::vector<std::shared_ptr<const Segment>> segments)
+    : segments_(std::move(segments)) {
+    if (!segments_.empty()) {
+        size_ = segments_.back()->base + segments_.back()->facts.size();
+    }
+}
+
+const Compound<std::string>& TermSnapshot::fact(FactId id) const {
+    if (id >= size_) {
+        throw std::out_of_range("TermSnapshot::fact: no fact with that ID");
+    }
+    // last segment starting at or before id
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), id,
+                               [](FactId value, const std::shared_ptr<const Segment>& seg) {
+                                   return value < seg->base;
+                               });
+    const Segment& segment = **(it - 1);
+    return segment.facts.fact(id - segment.base);
+}
+
+std::vector<TermSnapshot::FactId> TermSnapshot::candidates(const Term<std::string>& goal) const {
+    std::vector<FactId> out;
+    for (const auto& segment : segments_) {
+        for (FactId id : segment->facts.candidates(goal)) {
+            out.push_back(segment->base + id);
+        }
+    }
+    return out;
+}
+
+std::vector<TermSnapshot::Match> TermSnapshot::query(const Term<std::string>& goal,
+                                                     Unifier& unifier) const {
+    std::vector<Match> out;
+    Matches found = matches(goal, unifier);
+    while (auto match = found.next()) {
+        out.push_back(std::move(*match));
+    }
+    return out;
+}
+
+TermSnapshot::Matches::Matches(const TermSnapshot& snapshot, const Term<std::string>& goal,
+                               Unifier& unifier)
+    : snapshot_(&snapshot), goal_(&goal), unifier_(&unifier) {}
+
+std::optional<TermSnapshot::Match> TermSnapshot::Matches::next() {
+    const auto& segments = snapshot_->segments_;
+    while (segment_ < segments.size()) {
+        if (!current_) {
+            current_.emplace(segments[segment_]->facts.matches(*goal_, *unifier_));
+        }
+        if (auto match = current_->next()) {
+            match->fact += segments[segment_]->base;
+            return match;
+        }
+        current_.reset();
+        ++segment_;
+    }
+    return std::nullopt;
+}
+
+// --------------------------- SharedTermDatabase ---------------------------
+
+SharedTermDatabase::SharedTermDatabase() : current_(std::make_shared<const TermSnapshot>()) {}
+
+std::shared_ptr<const TermSnapshot> SharedTermDatabase::snapshot() const {
+    return std::atomic_load(&current_);
+}
+
+SharedTermDatabase::FactId SharedTermDatabase::publish(
+    std::vector<std::unique_ptr<Compound<std::string>>> facts) {
+    if (std::any_of(facts.begin(), facts.end(), [](const auto& fact) { return fact == nullptr; })) {
+        throw std::invalid_argument("SharedTermDatabase::publish given a null fact");
+    }
+
+    std::lock_guard<std::mutex> lock(writer_);
+    const std::shared_ptr<const TermSnapshot> old = std::atomic_load(&current_);
+    const FactId first = old->size();
+    if (facts.empty()) {
+        return first;
+    }
+
+    // carry: the new segment absorbs every trailing segment not larger than what it
+    // holds so far
+    std::vector<std::shared_ptr<const TermSnapshot::Segment>> segments = old->segments();
+    std::size_t merged = facts.size();
+    std::size_t keep = segments.size();
+    while (keep > 0 && segments[keep - 1]->facts.size() <= merged) {
+        merged += segments[keep - 1]->facts.size();
+        --keep;
+    }
+
+    auto segment = std::make_shared<TermSnapshot::Segment>();
+    segment->base = keep < segments.size() ? segments[keep]->base : first;
+    for (std::size_t i = keep; i < segments.size(); ++i) {
+        // published facts may still be read through older snapshots, so they are copied
+        const TermDatabase& previous = segments[i]->facts;
+        for (FactId id = 0; id < previous.size(); ++id) {
+            segment->facts.add(std::make_unique<Compound<std::string>>(previous.fact(id)));
+        }
+    }
+    for (auto& fact : facts) {
+        segment->facts.add(std::move(fact));
+    }
+    segments.resize(keep);
+    segments.push_back(std::move(segment));
+
+    std::shared_ptr<const TermSnapshot> next = std::make_shared<TermSnapshot>(std::move(segments));
+    std::atomic_store(&current_, std::move(next));
+    return first;
+}
+
+SharedTermDatabase::FactId SharedTermDatabase::add(std::unique_ptr<Compound<std::string>> fact) {
+    std::vector<std::unique_ptr<Compound<std::string>>> batch;
+    batch.push_back(std::move(fact));
+    return publish(std::move(batch));
+}
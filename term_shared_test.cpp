@@ -0,0 +1,114 @@
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_shared.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+using FactPtr = std::unique_ptr<Compound<std::string>>;
+
+// n(first), ..., n(first + count - 1).
+std::vector<FactPtr> batch(std::size_t first, std::size_t count) {
+    std::vector<FactPtr> facts;
+    for (std::size_t i = first; i < first + count; ++i) {
+        std::vector<TermPtr> args;
+        args.push_back(builders::constant(std::to_string(i)));
+        facts.push_back(std::make_unique<Compound<std::string>>("n", std::move(args)));
+    }
+    return facts;
+}
+
+void testPublish() {
+    SharedTermDatabase db;
+    std::shared_ptr<const TermSnapshot> empty = db.snapshot();
+    CHECK_EQ(empty->size(), 0u);
+    CHECK_EQ(db.publish(batch(0, 3)), 0u);
+    CHECK_EQ(db.add(std::move(batch(3, 1).front())), 3u);
+    std::shared_ptr<const TermSnapshot> four = db.snapshot();
+    CHECK_EQ(four->size(), 4u);
+    CHECK_EQ(empty->size(), 0u);
+    CHECK_EQ(formatTerm(four->fact(3)), "n(3)");
+
+    std::vector<FactPtr> broken = batch(4, 2);
+    broken.push_back(nullptr);
+    CHECK_THROWS(db.publish(std::move(broken)), std::invalid_argument);
+    CHECK_EQ(db.snapshot()->size(), 4u);
+
+    for (std::size_t i = 0; i < 64; ++i) {
+        db.add(std::move(batch(4 + i, 1).front()));
+    }
+    std::shared_ptr<const TermSnapshot> all = db.snapshot();
+    CHECK_EQ(all->size(), 68u);
+    CHECK(all->segments().size() <= 7u);
+    Unifier unifier;
+    TermPtr goal = parseTerm("n(X)");
+    std::vector<TermSnapshot::Match> matches = all->query(*goal, unifier);
+    bool ordered = matches.size() == 68;
+    for (std::size_t i = 0; ordered && i < matches.size(); ++i) {
+        ordered = matches[i].fact == i &&
+                  formatSubstitution(matches[i].substitution) == "X -> " + std::to_string(i);
+    }
+    CHECK(ordered);
+}
+
+// Readers querying while a writer publishes see whole batches only, never lose facts
+// they saw before, and keep an unchanged view for as long as they hold a snapshot.
+void testConcurrentReaders() {
+    constexpr std::size_t kBatch = 7;
+    constexpr std::size_t kBatches = 150;
+    SharedTermDatabase db;
+    std::atomic<bool> writing{true};
+    std::atomic<std::size_t> failures{0};
+    std::atomic<std::size_t> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            Unifier unifier;
+            TermPtr goal = parseTerm("n(X)");
+            std::size_t last = 0;
+            while (writing.load() || reads.load() < 3) {
+                std::shared_ptr<const TermSnapshot> snapshot = db.snapshot();
+                const std::size_t size = snapshot->size();
+                std::size_t seen = 0;
+                TermSnapshot::Matches matches = snapshot->matches(*goal, unifier);
+                while (auto match = matches.next()) {
+                    if (match->fact != seen) {
+                        ++failures;
+                    }
+                    ++seen;
+                }
+                if (size % kBatch != 0 || size < last || seen != size ||
+                    snapshot->size() != size) {
+                    ++failures;
+                }
+                last = size;
+                ++reads;
+            }
+        });
+    }
+    for (std::size_t b = 0; b < kBatches; ++b) {
+        db.publish(batch(b * kBatch, kBatch));
+        std::this_thread::yield();  // let readers run between publications
+    }
+    writing = false;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK_EQ(failures.load(), 0u);
+    CHECK(reads.load() >= 3u);
+    CHECK_EQ(db.snapshot()->size(), kBatch * kBatches);
+}
+
+int main() {
+    testPublish();
+    testConcurrentReaders();
+    return testSummary();
+}
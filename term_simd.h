@@ -0,0 +1,202 @@
+#ifndef TERM_SIMD_H
+#define TERM_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(TERM_SIMD_SCALAR) && defined(__AVX2__)
+#define TERM_SIMD_AVX2 1
+#include <immintrin.h>
+#elif !defined(TERM_SIMD_SCALAR) && defined(__SSE2__)
+#define TERM_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ------------------------------ BulkCompare -------------------------------
+// Comparison and scan loops over flat ID arrays, for TermStore and FlatHeap. They run on
+// AVX2 (32 bytes, so 8 IDs, per compare and 16 per loop iteration) when the library is
+// compiled with it enabled (-mavx2 or -march=native), on SSE2 (half that) on any other
+// x86-64 build, and as plain loops elsewhere or when TERM_SIMD_SCALAR is defined. The
+// choice is made at compile time like TERM_UNIFICATION_STATS, and all three give the
+// same results.
+class BulkCompare {
+public:
+    // A fixed-size record matched by findRecord(), e.g. a TermStore node.
+    using Record = std::uint8_t[16];
+
+    BulkCompare() = delete;
+
+    // Index of the first i < count with a[i] != b[i], or count when the arrays are equal.
+    static std::size_t firstMismatch(const std::uint32_t* a,
+                                     const std::uint32_t* b,
+                                     std::size_t count) noexcept;
+
+    // Offset of the first differing byte of two byte ranges, or bytes when they are equal.
+    static std::size_t firstMismatchByte(const void* a, const void* b, std::size_t bytes) noexcept;
+
+    // Index of the first of records[from .. count) (16 bytes each, packed) whose bytes
+    // selected by mask equal those of pattern, or count when there is none. Bytes outside
+    // mask, such as padding, are never compared.
+    static std::size_t findRecord(const void* records,
+                                  std::size_t from,
+                                  std::size_t count,
+                                  const Record& pattern,
+                                  const Record& mask) noexcept;
+
+private:
+    static std::size_t countTrailingZeros(std::uint32_t bits) noexcept;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline std::size_t BulkCompare::countTrailingZeros(std::uint32_t bits) noexcept {
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctz(bits));
+#else
+    std::size_t n = 0;
+    while ((bits & 1u) == 0) {
+        bits >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline std::size_t BulkCompare::firstMismatchByte(const void* a,
+                                                  const void* b,
+                                                  std::size_t bytes) noexcept {
+    const auto* x = static_cast<const unsigned char*>(a);
+    const auto* y = static_cast<const unsigned char*>(b);
+    std::size_t i = 0;
+#if defined(TERM_SIMD_AVX2)
+    // two vectors per iteration while they match; the single-vector loop finds the byte
+    for (; i + 64 <= bytes; i += 64) {
+        const __m256i eq0 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+        const __m256i eq1 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i + 32)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i + 32)));
+        if (_mm256_movemask_epi8(_mm256_and_si256(eq0, eq1)) != -1) {
+            break;
+        }
+    }
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i eq = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+        const auto differ = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(eq));
+        if (differ != 0) {
+            return i + countTrailingZeros(differ);
+        }
+    }
+#elif defined(TERM_SIMD_SSE2)
+    for (; i + 32 <= bytes; i += 32) {
+        const __m128i eq0 =
+            _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)),
+                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+        const __m128i eq1 =
+            _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i + 16)),
+                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i + 16)));
+        if (_mm_movemask_epi8(_mm_and_si128(eq0, eq1)) != 0xffff) {
+            break;
+        }
+    }
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i eq =
+            _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)),
+                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+        const auto differ = static_cast<std::uint32_t>(_mm_movemask_epi8(eq)) ^ 0xffffu;
+        if (differ != 0) {
+            return i + countTrailingZeros(differ);
+        }
+    }
+#else
+    for (; i + 8 <= bytes; i += 8) {
+        std::uint64_t wx;
+        std::uint64_t wy;
+        std::memcpy(&wx, x + i, 8);
+        std::memcpy(&wy, y + i, 8);
+        if (wx != wy) {
+            break;
+        }
+    }
+#endif
+    while (i < bytes && x[i] == y[i]) {
+        ++i;
+    }
+    return i;
+}
+
+inline std::size_t BulkCompare::firstMismatch(const std::uint32_t* a,
+                                              const std::uint32_t* b,
+                                              std::size_t count) noexcept {
+    // short argument lists are the common case; the vector set-up only pays off later
+    std::size_t i = 0;
+    for (; i < count && i < 4; ++i) {
+        if (a[i] != b[i]) {
+            return i;
+        }
+    }
+    if (i == count) {
+        return count;
+    }
+    return i + firstMismatchByte(a + i, b + i, (count - i) * sizeof(std::uint32_t)) /
+                   sizeof(std::uint32_t);
+}
+
+inline std::size_t BulkCompare::findRecord(const void* records,
+                                           std::size_t from,
+                                           std::size_t count,
+                                           const Record& pattern,
+                                           const Record& mask) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(records);
+    std::size_t i = from;
+#if defined(TERM_SIMD_AVX2)
+    const __m256i want = _mm256_broadcastsi128_si256(
+        _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern)),
+                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask))));
+    const __m256i keep =
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+    // two records per compare: the low 16 mask bits are record i, the high 16 record i + 1
+    for (; i + 2 <= count; i += 2) {
+        const __m256i got = _mm256_and_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i * 16)), keep);
+        const auto eq =
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(got, want)));
+        if ((eq & 0xffffu) == 0xffffu) {
+            return i;
+        }
+        if ((eq >> 16) == 0xffffu) {
+            return i + 1;
+        }
+    }
+#endif
+#if defined(TERM_SIMD_AVX2) || defined(TERM_SIMD_SSE2)
+    const __m128i keep128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+    const __m128i want128 =
+        _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern)), keep128);
+    for (; i < count; ++i) {
+        const __m128i got = _mm_and_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i * 16)), keep128);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(got, want128)) == 0xffff) {
+            return i;
+        }
+    }
+#else
+    for (; i < count; ++i) {
+        const unsigned char* record = bytes + i * 16;
+        bool same = true;
+        for (std::size_t k = 0; k < 16 && same; ++k) {
+            same = ((record[k] ^ pattern[k]) & mask[k]) == 0;
+        }
+        if (same) {
+            return i;
+        }
+    }
+#endif
+    return count;
+}
+
+#endif // TERM_SIMD_H
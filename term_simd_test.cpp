@@ -0,0 +1,133 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "term_simd.h"
+#include "term_test.h"
+
+// The vector kernels are compiled into this file, so building it with -mavx2, with no
+// flags (SSE2 on x86-64) and with -DTERM_SIMD_SCALAR checks each against the plain loops
+// below.
+
+std::size_t referenceMismatch(const std::uint32_t* a, const std::uint32_t* b, std::size_t count) {
+    std::size_t i = 0;
+    while (i < count && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t referenceMismatchByte(const unsigned char* a,
+                                  const unsigned char* b,
+                                  std::size_t bytes) {
+    std::size_t i = 0;
+    while (i < bytes && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t referenceFind(const unsigned char* records,
+                          std::size_t from,
+                          std::size_t count,
+                          const BulkCompare::Record& pattern,
+                          const BulkCompare::Record& mask) {
+    for (std::size_t r = from; r < count; ++r) {
+        bool same = true;
+        for (std::size_t k = 0; k < 16; ++k) {
+            same = same && ((records[r * 16 + k] ^ pattern[k]) & mask[k]) == 0;
+        }
+        if (same) {
+            return r;
+        }
+    }
+    return count;
+}
+
+// Every length up to several vector widths, with the arrays equal and with a single
+// difference at each offset, read from unaligned starts too.
+void testFirstMismatch() {
+    constexpr std::size_t kMax = 70;
+    bool agree = true;
+    for (std::size_t shift = 0; shift < 3; ++shift) {
+        std::vector<std::uint32_t> a(kMax + shift);
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            a[i] = static_cast<std::uint32_t>(i * 2654435761u);
+        }
+        for (std::size_t count = 0; count <= kMax; ++count) {
+            std::vector<std::uint32_t> b = a;
+            const std::uint32_t* x = a.data() + shift;
+            agree = agree && BulkCompare::firstMismatch(x, b.data() + shift, count) == count;
+            for (std::size_t at = 0; at < count; ++at) {
+                b[shift + at] ^= 1u << (at % 32);
+                agree = agree && BulkCompare::firstMismatch(x, b.data() + shift, count) ==
+                                     referenceMismatch(x, b.data() + shift, count);
+                b[shift + at] = a[shift + at];
+            }
+        }
+    }
+    CHECK(agree);
+}
+
+void testFirstMismatchByte() {
+    constexpr std::size_t kMax = 140;
+    bool agree = true;
+    for (std::size_t shift = 0; shift < 5; ++shift) {
+        std::vector<unsigned char> a(kMax + shift);
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            a[i] = static_cast<unsigned char>(i * 37 + 11);
+        }
+        for (std::size_t bytes = 0; bytes <= kMax; ++bytes) {
+            std::vector<unsigned char> b = a;
+            const unsigned char* x = a.data() + shift;
+            agree = agree && BulkCompare::firstMismatchByte(x, b.data() + shift, bytes) == bytes;
+            for (std::size_t at = 0; at < bytes; ++at) {
+                b[shift + at] ^= 0x80;
+                // a second difference further on must not be reported instead
+                if (at + 7 < bytes) {
+                    b[shift + at + 7] ^= 0x01;
+                }
+                agree = agree && BulkCompare::firstMismatchByte(x, b.data() + shift, bytes) ==
+                                     referenceMismatchByte(x, b.data() + shift, bytes);
+                b = a;
+            }
+        }
+    }
+    CHECK(agree);
+}
+
+// The matching record at each position, with a partial mask whose unmasked bytes differ.
+void testFindRecord() {
+    constexpr std::size_t kRecords = 23;
+    std::vector<unsigned char> records(kRecords * 16);
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        records[i] = static_cast<unsigned char>(i * 13 + 5);
+    }
+    BulkCompare::Record mask;
+    for (std::size_t k = 0; k < 16; ++k) {
+        mask[k] = k < 12 ? 0xff : 0x00;  // last four bytes are padding
+    }
+    bool agree = true;
+    for (std::size_t target = 0; target < kRecords; ++target) {
+        BulkCompare::Record pattern;
+        std::memcpy(pattern, records.data() + target * 16, 16);
+        pattern[13] ^= 0xff;  // outside the mask
+        for (std::size_t from = 0; from <= kRecords; ++from) {
+            agree = agree &&
+                    BulkCompare::findRecord(records.data(), from, kRecords, pattern, mask) ==
+                        referenceFind(records.data(), from, kRecords, pattern, mask);
+        }
+        pattern[3] ^= 0x01;  // inside the mask: no record matches
+        agree = agree &&
+                BulkCompare::findRecord(records.data(), 0, kRecords, pattern, mask) == kRecords;
+    }
+    CHECK(agree);
+}
+
+int main() {
+    testFirstMismatch();
+    testFirstMismatchByte();
+    testFindRecord();
+    return testSummary();
+}
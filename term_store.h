@@ -0,0 +1,153 @@
+#ifndef TERM_STORE_H
+#define TERM_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "term_memory.h"
+#include "term_symbols.h"
+#include "term_unification.h"
+
+// Integer handle for a node in a TermStore.
+using TermId = std::uint32_t;
+
+// ------------------------------- TermStore --------------------------------
+// Hash-consed, immutable term storage.
+// Every structurally distinct term exists exactly once, so equal IDs mean equal terms
+// and a duplicate f(a, g(b)) across many facts costs a single node.
+// Symbols (variable names, constants, functors) are interned in a per-store SymbolTable.
+class TermStore {
+public:
+    enum class Kind : std::uint8_t { Variable, Constant, Compound };
+
+    // Bindings from variable symbol to bound term; triangular (values may mention bound variables).
+    using Substitution = std::map<SymbolId, TermId>;
+
+    TermStore() = default;
+    TermStore(const TermStore&) = delete;
+    TermStore& operator=(const TermStore&) = delete;
+
+    // Node constructors; each returns the existing ID when an identical node is already stored.
+    TermId variable(std::string_view name);
+    TermId constant(std::string_view value);
+    TermId compound(std::string_view functor, const std::vector<TermId>& args);
+
+    // Imports a pointer-based term, sharing every subterm that is already stored.
+    TermId intern(const Term<std::string>& term);
+
+    // Rebuilds a pointer-based deep copy of a stored term.
+    std::unique_ptr<Term<std::string>> toTerm(TermId id) const;
+
+    // Same, with sub applied to every variable on the way.
+    std::unique_ptr<Term<std::string>> toTerm(TermId id, const Substitution& sub) const;
+
+    Kind kind(TermId id) const noexcept;
+
+    // Interned name of the variable, constant value or functor.
+    SymbolId symbol(TermId id) const noexcept;
+    const std::string& name(TermId id) const noexcept;
+
+    // Number of arguments (0 for variables and constants).
+    std::size_t arity(TermId id) const noexcept;
+
+    // Access the i-th argument of a compound (throws std::out_of_range on bad index).
+    TermId arg(TermId id, std::size_t index) const;
+
+    // True when the term contains no variables.
+    bool isGround(TermId id) const noexcept;
+
+    // Number of distinct nodes stored.
+    std::size_t size() const noexcept;
+
+    // IDs of the stored compounds functor/arity in ID order, e.g. every fact of one
+    // predicate. The node headers are scanned in bulk (see BulkCompare::findRecord)
+    // rather than one node at a time.
+    std::vector<TermId> compoundsWith(std::string_view functor, std::size_t arity) const;
+
+    const SymbolTable& symbols() const noexcept;
+
+    // Bytes held by the store, by node kind. A node costs 16 bytes plus 4 per argument,
+    // against a pointer-based node's vtable, kind and argument pointers.
+    MemoryFootprint memoryFootprint() const;
+
+    // Compact mode for a store that is done growing: gives back the capacity reserved
+    // for further nodes and arguments. Adding nodes afterwards still works.
+    void shrinkToFit();
+
+    // Unifies two stored terms. Identical subterms are accepted and distinct ground
+    // subterms rejected with a single ID comparison; no new nodes are created.
+    std::optional<Substitution> unify(TermId a, TermId b) const;
+
+    // Applies sub to a stored term, storing (and sharing) the result.
+    TermId substitute(TermId id, const Substitution& sub);
+
+    // Converts ID bindings to the pointer-based form with every value fully applied.
+    Unifier::Substitution toSubstitution(const Substitution& sub) const;
+
+private:
+    struct Node {
+        Kind kind;
+        bool ground;
+        SymbolId symbol;
+        std::uint32_t firstArg;  // offset into args_
+        std::uint32_t arity;
+    };
+
+    static constexpr TermId kEmptySlot = static_cast<TermId>(-1);
+
+    SymbolTable symbols_;
+    std::vector<Node> nodes_;
+    std::vector<TermId> args_;
+    std::vector<TermId> table_;  // open-addressing hash set of node IDs
+
+    TermId makeNode(Kind kind, SymbolId symbol, const TermId* args, std::size_t arity);
+    std::size_t hashNode(Kind kind, SymbolId symbol, const TermId* args, std::size_t arity) const;
+    bool sameNode(TermId id, Kind kind, SymbolId symbol, const TermId* args, std::size_t arity) const;
+    void growTable();
+
+    // Traversals below keep explicit work stacks, so term depth is bounded by memory
+    // rather than the call stack (e.g. 100k-cell lists).
+    TermId walk(TermId id, const Substitution& sub) const;
+    std::unique_ptr<Term<std::string>> build(TermId id, const Substitution* sub) const;
+    bool occurs(SymbolId var, TermId id, const Substitution& sub,
+                std::vector<TermId>& scan) const;
+    bool unifyInternal(TermId a, TermId b, Substitution& working) const;
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline TermStore::Kind TermStore::kind(TermId id) const noexcept {
+    return nodes_[id].kind;
+}
+
+inline SymbolId TermStore::symbol(TermId id) const noexcept {
+    return nodes_[id].symbol;
+}
+
+inline const std::string& TermStore::name(TermId id) const noexcept {
+    return symbols_.name(nodes_[id].symbol);
+}
+
+inline std::size_t TermStore::arity(TermId id) const noexcept {
+    return nodes_[id].arity;
+}
+
+inline bool TermStore::isGround(TermId id) const noexcept {
+    return nodes_[id].ground;
+}
+
+inline std::size_t TermStore::size() const noexcept {
+    return nodes_.size();
+}
+
+inline const SymbolTable& TermStore::symbols() const noexcept {
+    return symbols_;
+}
+
+#endif // TERM_STORE_H
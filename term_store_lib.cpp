@@ -0,0 +1,368 @@
+#include "term_store.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "term_simd.h"
+
+namespace {
+
+std::size_t mix(std::size_t seed, std::size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+}  // namespace
+
+TermId TermStore::variable(std::string_view name) {
+    return makeNode(Kind::Variable, symbols_.intern(name), nullptr, 0);
+}
+
+TermId TermStore::constant(std::string_view value) {
+    return makeNode(Kind::Constant, symbols_.intern(value), nullptr, 0);
+}
+
+TermId TermStore::compound(std::string_view functor, const std::vector<TermId>& args) {
+    return makeNode(Kind::Compound, symbols_.intern(functor), args.data(), args.size());
+}
+
+TermId TermStore::intern(const Term<std::string>& term) {
+    // post-order: argument IDs finish on done in order, then their compound is stored
+    struct Task {
+        const Term<std::string>* term;
+        bool expanded;
+    };
+    std::vector<Task> tasks{Task{&term, false}};
+    std::vector<TermId> done;
+    while (!tasks.empty()) {
+        const Task task = tasks.back();
+        tasks.pop_back();
+
+        switch (task.term->kind()) {
+        case TermKind::Variable:
+            done.push_back(variable(termCast<Variable>(*task.term).name()));
+            break;
+        case TermKind::Constant:
+            done.push_back(constant(termCast<Constant>(*task.term).value()));
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(*task.term);
+            if (task.expanded) {
+                const std::size_t first = done.size() - comp.arity();
+                const TermId id = makeNode(Kind::Compound, symbols_.intern(comp.functor()),
+                                           done.data() + first, comp.arity());
+                done.resize(first);
+                done.push_back(id);
+                break;
+            }
+            tasks.push_back(Task{task.term, true});
+            for (std::size_t i = comp.arity(); i > 0; --i) {
+                tasks.push_back(Task{&comp.arg(i - 1), false});
+            }
+            break;
+        }
+        }
+    }
+    return done.back();
+}
+
+std::unique_ptr<Term<std::string>> TermStore::toTerm(TermId id) const {
+    return build(id, nullptr);
+}
+
+TermId TermStore::arg(TermId id, std::size_t index) const {
+    const Node& node = nodes_[id];
+    if (index >= node.arity) {
+        throw std::out_of_range("TermStore::arg index out of range");
+    }
+    return args_[node.firstArg + index];
+}
+
+std::vector<TermId> TermStore::compoundsWith(std::string_view functor, std::size_t arity) const {
+    static_assert(sizeof(Node) == sizeof(BulkCompare::Record), "nodes are scanned as records");
+    std::vector<TermId> out;
+    const std::optional<SymbolId> symbol = symbols_.find(functor);
+    if (!symbol || arity > 0xffffffffu) {
+        return out;
+    }
+    // match kind, symbol and arity; ground, firstArg and padding are masked out
+    const Node want{Kind::Compound, false, *symbol, 0, static_cast<std::uint32_t>(arity)};
+    BulkCompare::Record pattern = {};
+    BulkCompare::Record mask = {};
+    std::memcpy(&pattern[offsetof(Node, kind)], &want.kind, sizeof want.kind);
+    std::memcpy(&pattern[offsetof(Node, symbol)], &want.symbol, sizeof want.symbol);
+    std::memcpy(&pattern[offsetof(Node, arity)], &want.arity, sizeof want.arity);
+    std::memset(&mask[offsetof(Node, kind)], 0xff, sizeof want.kind);
+    std::memset(&mask[offsetof(Node, symbol)], 0xff, sizeof want.symbol);
+    std::memset(&mask[offsetof(Node, arity)], 0xff, sizeof want.arity);
+    for (std::size_t i = BulkCompare::findRecord(nodes_.data(), 0, nodes_.size(), pattern, mask);
+         i < nodes_.size();
+         i = BulkCompare::findRecord(nodes_.data(), i + 1, nodes_.size(), pattern, mask)) {
+        out.push_back(static_cast<TermId>(i));
+    }
+    return out;
+}
+
+MemoryFootprint TermStore::memoryFootprint() const {
+    MemoryFootprint out;
+    for (const Node& node : nodes_) {
+        MemoryFootprint::Part& part = node.kind == Kind::Variable   ? out.variables
+                                      : node.kind == Kind::Constant ? out.constants
+                                                                    : out.compounds;
+        ++part.count;
+        part.bytes += sizeof(Node) + node.arity * sizeof(TermId);
+    }
+    out.symbols = symbols_.memoryUsage();
+    out.overhead = (nodes_.capacity() - nodes_.size()) * sizeof(Node) +
+                   (args_.capacity() - args_.size()) * sizeof(TermId) +
+                   table_.capacity() * sizeof(TermId);
+    return out;
+}
+
+void TermStore::shrinkToFit() {
+    nodes_.shrink_to_fit();
+    args_.shrink_to_fit();
+}
+
+std::optional<TermStore::Substitution> TermStore::unify(TermId a, TermId b) const {
+    Substitution working;
+    if (!unifyInternal(a, b, working)) {
+        return std::nullopt;
+    }
+    return working;
+}
+
+TermId TermStore::substitute(TermId id, const Substitution& sub) {
+    // post-order like intern(); ground subterms are shared as they are
+    struct Task {
+        TermId id;
+        bool expanded;
+    };
+    std::vector<Task> tasks{Task{id, false}};
+    std::vector<TermId> done;
+    while (!tasks.empty()) {
+        const Task task = tasks.back();
+        tasks.pop_back();
+
+        if (task.expanded) {
+            // copy the node: makeNode may grow nodes_
+            const Node node = nodes_[task.id];
+            const std::size_t first = done.size() - node.arity;
+            const TermId result =
+                makeNode(Kind::Compound, node.symbol, done.data() + first, node.arity);
+            done.resize(first);
+            done.push_back(result);
+            continue;
+        }
+
+        const TermId resolved = walk(task.id, sub);
+        const Node& node = nodes_[resolved];
+        if (node.ground || node.kind != Kind::Compound) {
+            done.push_back(resolved);
+            continue;
+        }
+        tasks.push_back(Task{resolved, true});
+        for (std::uint32_t i = node.arity; i > 0; --i) {
+            tasks.push_back(Task{args_[node.firstArg + i - 1], false});
+        }
+    }
+    return done.back();
+}
+
+std::unique_ptr<Term<std::string>> TermStore::toTerm(TermId id, const Substitution& sub) const {
+    return build(id, &sub);
+}
+
+Unifier::Substitution TermStore::toSubstitution(const Substitution& sub) const {
+    Unifier::Substitution out;
+    for (const auto& [var, value] : sub) {
+        out[symbols_.name(var)] = toTerm(value, sub);
+    }
+    return out;
+}
+
+TermId TermStore::makeNode(Kind kind, SymbolId symbol, const TermId* args, std::size_t arity) {
+    if ((nodes_.size() + 1) * 2 > table_.size()) {
+        growTable();
+    }
+    const std::size_t mask = table_.size() - 1;
+    std::size_t slot = hashNode(kind, symbol, args, arity) & mask;
+    while (table_[slot] != kEmptySlot) {
+        if (sameNode(table_[slot], kind, symbol, args, arity)) {
+            return table_[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    bool ground = kind != Kind::Variable;
+    for (std::size_t i = 0; i < arity && ground; ++i) {
+        ground = nodes_[args[i]].ground;
+    }
+    const auto id = static_cast<TermId>(nodes_.size());
+    nodes_.push_back(Node{kind, ground, symbol, static_cast<std::uint32_t>(args_.size()),
+                          static_cast<std::uint32_t>(arity)});
+    args_.insert(args_.end(), args, args + arity);
+    table_[slot] = id;
+    return id;
+}
+
+std::size_t TermStore::hashNode(Kind kind, SymbolId symbol, const TermId* args,
+                                std::size_t arity) const {
+    std::size_t h = mix(static_cast<std::size_t>(kind), symbol);
+    h = mix(h, arity);
+    for (std::size_t i = 0; i < arity; ++i) {
+        h = mix(h, args[i]);
+    }
+    return h;
+}
+
+bool TermStore::sameNode(TermId id, Kind kind, SymbolId symbol, const TermId* args,
+                         std::size_t arity) const {
+    const Node& node = nodes_[id];
+    if (node.kind != kind || node.symbol != symbol || node.arity != arity) {
+        return false;
+    }
+    return BulkCompare::firstMismatch(args_.data() + node.firstArg, args, arity) == arity;
+}
+
+void TermStore::growTable() {
+    std::vector<TermId> bigger(table_.empty() ? 64 : table_.size() * 2, kEmptySlot);
+    const std::size_t mask = bigger.size() - 1;
+    for (TermId id = 0; id < nodes_.size(); ++id) {
+        const Node& node = nodes_[id];
+        std::size_t slot = hashNode(node.kind, node.symbol, args_.data() + node.firstArg,
+                                    node.arity) & mask;
+        while (bigger[slot] != kEmptySlot) {
+            slot = (slot + 1) & mask;
+        }
+        bigger[slot] = id;
+    }
+    table_ = std::move(bigger);
+}
+
+TermId TermStore::walk(TermId id, const Substitution& sub) const {
+    while (nodes_[id].kind == Kind::Variable) {
+        auto it = sub.find(nodes_[id].symbol);
+        if (it == sub.end()) {
+            break;
+        }
+        id = it->second;
+    }
+    return id;
+}
+
+std::unique_ptr<Term<std::string>> TermStore::build(TermId id, const Substitution* sub) const {
+    TermCloner<TermId> cloner;
+    return cloner.build(id, [&](TermId node, auto& step) {
+        const Node& resolved = nodes_[sub != nullptr ? walk(node, *sub) : node];
+        switch (resolved.kind) {
+        case Kind::Variable:
+            step.leaf(std::make_unique<Variable>(symbols_.name(resolved.symbol)));
+            break;
+        case Kind::Constant:
+            step.leaf(std::make_unique<Constant>(symbols_.name(resolved.symbol)));
+            break;
+        case Kind::Compound:
+            step.compound(symbols_.name(resolved.symbol), resolved.arity);
+            for (std::uint32_t i = 0; i < resolved.arity; ++i) {
+                step.child(args_[resolved.firstArg + i]);
+            }
+            break;
+        }
+    });
+}
+
+bool TermStore::occurs(SymbolId var, TermId id, const Substitution& sub,
+                       std::vector<TermId>& scan) const {
+    scan.clear();
+    scan.push_back(id);
+    while (!scan.empty()) {
+        TermId current = scan.back();
+        scan.pop_back();
+        if (nodes_[current].ground) {
+            continue;
+        }
+        current = walk(current, sub);
+        const Node& node = nodes_[current];
+        if (node.kind == Kind::Variable) {
+            if (node.symbol == var) {
+                return true;
+            }
+            continue;
+        }
+        for (std::uint32_t i = 0; i < node.arity; ++i) {
+            scan.push_back(args_[node.firstArg + i]);
+        }
+    }
+    return false;
+}
+
+bool TermStore::unifyInternal(TermId a, TermId b, Substitution& working) const {
+    std::vector<std::pair<TermId, TermId>> pairs{{a, b}};
+    std::vector<TermId> scan;  // occurs-check work list, reused across bindings
+    while (!pairs.empty()) {
+        const TermId x = walk(pairs.back().first, working);
+        const TermId y = walk(pairs.back().second, working);
+        pairs.pop_back();
+
+        // identical nodes are identical terms
+        if (x == y) {
+            continue;
+        }
+
+        const Node& lhs = nodes_[x];
+        const Node& rhs = nodes_[y];
+
+        // same rule as Unifier: bind the lexicographically smaller variable to the other
+        if (lhs.kind == Kind::Variable && rhs.kind == Kind::Variable) {
+            if (symbols_.name(lhs.symbol) < symbols_.name(rhs.symbol)) {
+                working[lhs.symbol] = y;
+            } else {
+                working[rhs.symbol] = x;
+            }
+            continue;
+        }
+
+        if (lhs.kind == Kind::Variable) {
+            if (occurs(lhs.symbol, y, working, scan)) {
+                return false;
+            }
+            working[lhs.symbol] = y;
+            continue;
+        }
+
+        if (rhs.kind == Kind::Variable) {
+            if (occurs(rhs.symbol, x, working, scan)) {
+                return false;
+            }
+            working[rhs.symbol] = x;
+            continue;
+        }
+
+        // distinct ground nodes can never be made equal
+        if (lhs.ground && rhs.ground) {
+            return false;
+        }
+
+        if (lhs.kind != Kind::Compound || rhs.kind != Kind::Compound ||
+            lhs.symbol != rhs.symbol || lhs.arity != rhs.arity) {
+            return false;
+        }
+        // identical arguments unify as they are, so runs of them are skipped in bulk;
+        // the differing pairs are queued leftmost on top
+        const TermId* xs = args_.data() + lhs.firstArg;
+        const TermId* ys = args_.data() + rhs.firstArg;
+        const std::size_t queued = pairs.size();
+        for (std::size_t i = 0; i < lhs.arity; ++i) {
+            i += BulkCompare::firstMismatch(xs + i, ys + i, lhs.arity - i);
+            if (i == lhs.arity) {
+                break;
+            }
+            pairs.emplace_back(xs[i], ys[i]);
+        }
+        std::reverse(pairs.begin() + queued, pairs.end());
+    }
+    return true;
+}
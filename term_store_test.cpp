@@ -0,0 +1,88 @@
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "term_format.h"
+#include "term_store.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// cons(a, cons(a, ... tail)) with length cells, built bottom-up in the store.
+TermId storedList(TermStore& store, std::size_t length, TermId tail) {
+    const TermId head = store.constant("a");
+    for (std::size_t i = 0; i < length; ++i) {
+        tail = store.compound("cons", {head, tail});
+    }
+    return tail;
+}
+
+// Structurally equal terms get one ID, also when imported from pointer terms.
+void testHashConsing() {
+    using namespace builders;
+    TermStore store;
+    const TermId a = store.constant("a");
+    const TermId fa = store.compound("f", {a, store.compound("g", {store.constant("b")})});
+    CHECK_EQ(store.compound("f", {a, store.compound("g", {store.constant("b")})}), fa);
+    CHECK_EQ(store.intern(*compound("f", constant("a"), compound("g", constant("b")))), fa);
+    CHECK(store.variable("a") != a);
+    CHECK(store.isGround(fa));
+    CHECK(!store.isGround(store.compound("f", {store.variable("X")})));
+    CHECK_EQ(store.name(fa), "f");
+    CHECK_EQ(store.arity(fa), 2u);
+    CHECK_THROWS(store.arg(fa, 2), std::out_of_range);
+    CHECK_EQ(formatTerm(*store.toTerm(fa)), "f(a, g(b))");
+    CHECK(store.compoundsWith("f", 2) == std::vector<TermId>{fa});
+}
+
+void testUnify() {
+    TermStore store;
+    const TermId x = store.variable("X");
+    const TermId y = store.variable("Y");
+    const TermId lhs = store.compound("f", {x, store.compound("g", {y})});
+    const TermId rhs = store.compound("f", {store.constant("k"), store.compound("g", {x})});
+    auto sub = store.unify(lhs, rhs);
+    CHECK(sub.has_value());
+    if (sub) {
+        CHECK_EQ(formatSubstitution(store.toSubstitution(*sub)), "X -> k, Y -> k");
+        CHECK_EQ(store.substitute(lhs, *sub), store.substitute(rhs, *sub));
+    }
+    CHECK(!store.unify(store.constant("a"), store.constant("b")).has_value());
+    CHECK(!store.unify(x, store.compound("f", {x})).has_value());
+}
+
+// Every traversal keeps its own stack, so a 100k-cell list neither recurses nor crashes.
+void testDeepList() {
+    constexpr std::size_t kLength = 100000;
+    TermStore store;
+    const TermId nil = store.constant("nil");
+    const TermId tail = store.variable("T");
+    const TermId closed = storedList(store, kLength, nil);
+    const TermId open = storedList(store, kLength, tail);
+
+    TermPtr pointer = store.toTerm(closed);
+    CHECK_EQ(store.intern(*pointer), closed);
+    TermStore other;
+    CHECK_EQ(other.intern(*pointer), storedList(other, kLength, other.constant("nil")));
+
+    auto sub = store.unify(open, closed);
+    CHECK(sub.has_value());
+    if (sub) {
+        CHECK_EQ(sub->size(), 1u);
+        CHECK_EQ(store.substitute(open, *sub), closed);
+        CHECK_EQ(store.intern(*store.toTerm(open, *sub)), closed);
+    }
+
+    // T = cons(a, ... T) must be found by the occurs check at the bottom of the list
+    CHECK(!store.unify(tail, open).has_value());
+}
+
+int main() {
+    testHashConsing();
+    testUnify();
+    testDeepList();
+    return testSummary();
+}
@@ -0,0 +1,113 @@
+#ifndef TERM_SYMBOLS_H
+#define TERM_SYMBOLS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Dense integer handle for an interned symbol (variable name, constant or functor).
+using SymbolId = std::uint32_t;
+
+// ----------------------------- SymbolTable --------------------------------
+// Maps symbol text to dense integer IDs and back.
+// IDs are assigned in first-seen order starting at 0 and never change.
+class SymbolTable {
+private:
+    // deque keeps element addresses stable, so index_ can key on views into it
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, SymbolId> index_;
+
+public:
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Returns the ID for text, assigning a new one on first sight.
+    SymbolId intern(std::string_view text);
+
+    // Returns the ID for text if it was interned before.
+    std::optional<SymbolId> find(std::string_view text) const;
+
+    // Returns the text for an ID (undefined for IDs not produced by this table).
+    const std::string& name(SymbolId id) const noexcept;
+
+    // Number of distinct symbols interned so far.
+    std::size_t size() const noexcept;
+
+    // Estimated bytes held by the table: texts and lookup index (see MemoryFootprint).
+    std::size_t memoryUsage() const noexcept;
+};
+
+// ---------------------------- SymbolRegistry ------------------------------
+// Process-wide symbol tables behind the term classes: one for variable names and one
+// for constants and functors, so both ID ranges stay dense from 0. Safe to call from any
+// thread: each thread remembers the symbols it has interned and finds them again without
+// locking, and a new text locks only one of several shards of its table. IDs are never
+// reused, and interned text is kept for the rest of the program.
+class SymbolRegistry {
+public:
+    // An interned atom: its ID and the registry's copy of its text, which stays valid
+    // (at the same address) for the rest of the program.
+    struct InternedSymbol {
+        SymbolId id;
+        const std::string* text;
+    };
+
+    SymbolRegistry() = delete;
+
+    // ID of a variable name, assigned on first sight.
+    static SymbolId variable(std::string_view name);
+
+    // Same as variable(), also returning the stored name.
+    static InternedSymbol internVariable(std::string_view name);
+
+    // A variable name interned for the first time by this call, unique across the whole
+    // process. Names have the form _N, which the parser reads back as this same variable,
+    // so formatted terms round-trip; names already interned (say, written by hand) are
+    // skipped.
+    static InternedSymbol freshVariable();
+
+    // ID of a constant value or functor name, assigned on first sight.
+    static SymbolId atom(std::string_view text);
+
+    // Same as atom(), also returning the stored text.
+    static InternedSymbol internAtom(std::string_view text);
+
+    // Number of distinct variable names interned so far (one past the largest ID).
+    static std::size_t variableCount();
+};
+
+// ------------------------- Inline Implementations ------------------------
+
+inline SymbolId SymbolTable::intern(std::string_view text) {
+    auto it = index_.find(text);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<SymbolId>(names_.size());
+    names_.emplace_back(text);
+    index_.emplace(names_.back(), id);
+    return id;
+}
+
+inline std::optional<SymbolId> SymbolTable::find(std::string_view text) const {
+    auto it = index_.find(text);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+inline const std::string& SymbolTable::name(SymbolId id) const noexcept {
+    return names_[id];
+}
+
+inline std::size_t SymbolTable::size() const noexcept {
+    return names_.size();
+}
+
+#endif // TERM_SYMBOLS_H
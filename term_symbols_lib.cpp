@@ -0,0 +1,125 @@
+#include "term_symbols.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "term_memory.h"
+
+namespace {
+
+using InternedSymbol = SymbolRegistry::InternedSymbol;
+
+// Texts are spread over this many independently locked shards by hash.
+constexpr std::size_t kShards = 16;
+
+// Entries a thread's cache holds before it starts over; bounds the memory a thread that
+// has seen many symbols keeps.
+constexpr std::size_t kCacheLimit = 1 << 14;
+
+struct Shard {
+    std::mutex mutex;
+    std::deque<std::string> names;  // stable addresses, so index can key on views
+    std::unordered_map<std::string_view, InternedSymbol> index;
+};
+
+// One process-wide table. IDs come from one counter, so they stay dense from 0 however
+// the texts are sharded. Function-local statics below, so terms built during static
+// initialization still find the tables constructed.
+struct SharedTable {
+    Shard shards[kShards];
+    std::atomic<SymbolId> next{0};
+    std::atomic<std::size_t> fresh{0};  // number tried next by freshVariable()
+};
+
+enum TableIndex { kVariables, kAtoms };
+
+SharedTable& sharedTable(TableIndex which) {
+    static SharedTable tables[2];
+    return tables[which];
+}
+
+// Symbols this thread has interned before. Views point into the shards, whose texts
+// live for the rest of the program, so hits take no lock at all.
+std::unordered_map<std::string_view, InternedSymbol>& localCache(TableIndex which) {
+    thread_local std::unordered_map<std::string_view, InternedSymbol> caches[2];
+    return caches[which];
+}
+
+// Interns text in the shard it hashes to; added tells whether this call stored it.
+InternedSymbol internInShard(SharedTable& table, std::string_view text, bool& added) {
+    Shard& shard = table.shards[std::hash<std::string_view>{}(text) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(text);
+    added = it == shard.index.end();
+    if (!added) {
+        return it->second;
+    }
+    shard.names.emplace_back(text);
+    const InternedSymbol symbol{table.next.fetch_add(1), &shard.names.back()};
+    shard.index.emplace(shard.names.back(), symbol);
+    return symbol;
+}
+
+InternedSymbol internShared(TableIndex which, std::string_view text) {
+    auto& cache = localCache(which);
+    auto hit = cache.find(text);
+    if (hit != cache.end()) {
+        return hit->second;
+    }
+    bool added = false;
+    const InternedSymbol symbol = internInShard(sharedTable(which), text, added);
+    if (cache.size() >= kCacheLimit) {
+        cache.clear();
+    }
+    cache.emplace(*symbol.text, symbol);
+    return symbol;
+}
+
+}  // namespace
+
+std::size_t SymbolTable::memoryUsage() const noexcept {
+    std::size_t bytes = names_.size() * sizeof(std::string) +
+                        index_.bucket_count() * sizeof(void*) +
+                        index_.size() * MemoryFootprint::hashEntryBytes(sizeof(*index_.begin()));
+    for (const std::string& name : names_) {
+        bytes += MemoryFootprint::heapBytes(name);
+    }
+    return bytes;
+}
+
+SymbolId SymbolRegistry::variable(std::string_view name) {
+    return internShared(kVariables, name).id;
+}
+
+SymbolId SymbolRegistry::atom(std::string_view text) {
+    return internShared(kAtoms, text).id;
+}
+
+SymbolRegistry::InternedSymbol SymbolRegistry::internVariable(std::string_view name) {
+    return internShared(kVariables, name);
+}
+
+SymbolRegistry::InternedSymbol SymbolRegistry::internAtom(std::string_view text) {
+    return internShared(kAtoms, text);
+}
+
+SymbolRegistry::InternedSymbol SymbolRegistry::freshVariable() {
+    SharedTable& table = sharedTable(kVariables);
+    // a term built by hand may already use a name of this form; skip those
+    for (;;) {
+        const std::string name = "_" + std::to_string(table.fresh.fetch_add(1));
+        bool added = false;
+        const InternedSymbol symbol = internInShard(table, name, added);
+        if (added) {
+            return symbol;
+        }
+    }
+}
+
+std::size_t SymbolRegistry::variableCount() {
+    return sharedTable(kVariables).next.load();
+}
@@ -0,0 +1,147 @@
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "term_symbols.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+void testSymbolTable() {
+    SymbolTable table;
+    CHECK_EQ(table.intern("f"), 0u);
+    CHECK_EQ(table.intern("g"), 1u);
+    CHECK_EQ(table.intern("f"), 0u);
+    CHECK_EQ(table.size(), 2u);
+    CHECK_EQ(table.name(1), "g");
+    CHECK(table.find("g") == SymbolId{1});
+    CHECK(!table.find("h").has_value());
+    CHECK(table.memoryUsage() > 0);
+}
+
+// Terms with the same text share one ID and one stored string; variables and atoms are
+// separate tables.
+void testRegistry() {
+    using namespace builders;
+    TermPtr x1 = var("X");
+    TermPtr x2 = var("X");
+    TermPtr a1 = constant("X");
+    const auto& v1 = termCast<Variable>(*x1);
+    const auto& v2 = termCast<Variable>(*x2);
+    CHECK_EQ(v1.id(), v2.id());
+    CHECK(&v1.name() == &v2.name());
+    CHECK_EQ(termCast<Constant>(*a1).id(), SymbolRegistry::atom("X"));
+    CHECK_EQ(v1.id(), SymbolRegistry::variable("X"));
+    CHECK(SymbolRegistry::variableCount() > v1.id());
+
+    // concurrent interning of one name agrees on its ID
+    std::vector<SymbolId> ids(8);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        threads.emplace_back([&ids, i] { ids[i] = SymbolRegistry::variable("Shared13"); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    bool same = true;
+    for (SymbolId id : ids) {
+        same = same && id == ids[0];
+    }
+    CHECK(same);
+}
+
+// Threads interning overlapping sets of names agree on every ID, distinct names get
+// distinct IDs, and IDs stay dense.
+void testConcurrentInterning() {
+    constexpr std::size_t kThreads = 4;
+    constexpr std::size_t kNames = 2000;
+    const std::size_t before = SymbolRegistry::variableCount();
+    std::vector<std::vector<SymbolId>> ids(kThreads, std::vector<SymbolId>(kNames));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&ids, t] {
+            // each thread walks the names from a different starting point, twice
+            for (std::size_t round = 0; round < 2; ++round) {
+                for (std::size_t k = 0; k < kNames; ++k) {
+                    const std::size_t n = (k + t * kNames / kThreads) % kNames;
+                    ids[t][n] = SymbolRegistry::variable("Conc13_" + std::to_string(n));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    bool agree = true;
+    std::set<SymbolId> distinct;
+    for (std::size_t n = 0; n < kNames; ++n) {
+        for (std::size_t t = 1; t < kThreads; ++t) {
+            agree = agree && ids[t][n] == ids[0][n];
+        }
+        distinct.insert(ids[0][n]);
+    }
+    CHECK(agree);
+    CHECK_EQ(distinct.size(), kNames);
+    CHECK_EQ(SymbolRegistry::variableCount(), before + kNames);
+    CHECK(*distinct.rbegin() < SymbolRegistry::variableCount());
+    CHECK_EQ(ids[0][7], SymbolRegistry::variable("Conc13_7"));
+    CHECK_EQ(SymbolRegistry::internVariable("Conc13_7").id, ids[0][7]);
+}
+
+// Memory resource that counts the bytes handed out.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t allocated = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Bindings storage follows the number of variables bound, not the size of their IDs.
+void testBindingsStorage() {
+    for (std::size_t i = 0; i < 50000; ++i) {
+        SymbolRegistry::variable("Wide13_" + std::to_string(i));
+    }
+    TermPtr x = builders::var("Wide13_late_X");
+    TermPtr y = builders::var("Wide13_late_Y");
+    TermPtr a = builders::constant("a");
+    CHECK(termCast<Variable>(*x).id() >= 50000u);
+
+    CountingResource resource;
+    Bindings bindings(&resource);
+    const Bindings::Mark start = bindings.mark();
+    bindings.bind(termCast<Variable>(*x), *y);
+    bindings.bind(termCast<Variable>(*y), *a);
+    CHECK(resource.allocated < 4096);
+    CHECK(&bindings.resolve(*x) == a.get());
+    CHECK_EQ(bindings.size(), 2u);
+
+    bindings.undoTo(start);
+    CHECK(bindings.empty());
+    CHECK(bindings.lookup(termCast<Variable>(*x)) == nullptr);
+    bindings.bind(termCast<Variable>(*y), *x);
+    CHECK(bindings.lookup(termCast<Variable>(*y)) == x.get());
+    bindings.clear();
+    CHECK(bindings.lookup(termCast<Variable>(*y)) == nullptr);
+}
+
+int main() {
+    testSymbolTable();
+    testRegistry();
+    testConcurrentInterning();
+    testBindingsStorage();
+    return testSummary();
+}
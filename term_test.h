@@ -0,0 +1,77 @@
+#ifndef TERM_TEST_H
+#define TERM_TEST_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// ------------------------------- Test checks ------------------------------
+// Minimal checks shared by the term_*_test.cpp programs. Each program is built like the
+// client, from every *_lib.cpp plus the test file, e.g.
+//   g++ -std=c++17 -pthread *_lib.cpp term_store_test.cpp
+// and prints one line per failed check followed by a summary; main returns
+// testSummary(), which is non-zero once any check failed.
+//
+//   CHECK(cond)              cond holds
+//   CHECK_EQ(actual, want)   actual == want; both are printed on failure
+//   CHECK_THROWS(expr, E)    evaluating expr throws an E
+
+namespace term_test {
+
+struct Counts {
+    std::size_t run = 0;
+    std::size_t failed = 0;
+};
+
+inline Counts& counts() {
+    static Counts state;
+    return state;
+}
+
+inline void record(bool ok, const char* file, int line, const std::string& what) {
+    ++counts().run;
+    if (!ok) {
+        ++counts().failed;
+        std::cout << file << ":" << line << ": check failed: " << what << "\n";
+    }
+}
+
+template <typename A, typename B>
+void recordEqual(const A& actual, const B& want, const char* file, int line, const char* text) {
+    const bool ok = actual == want;
+    if (ok) {
+        record(true, file, line, text);
+        return;
+    }
+    std::cout << file << ":" << line << ": got " << actual << ", want " << want << "\n";
+    record(false, file, line, text);
+}
+
+}  // namespace term_test
+
+#define CHECK(cond) ::term_test::record(static_cast<bool>(cond), __FILE__, __LINE__, #cond)
+
+#define CHECK_EQ(actual, want) \
+    ::term_test::recordEqual((actual), (want), __FILE__, __LINE__, #actual " == " #want)
+
+#define CHECK_THROWS(expr, E)                                                           \
+    do {                                                                                \
+        bool thrown = false;                                                            \
+        try {                                                                           \
+            (void)(expr);                                                               \
+        } catch (const E&) {                                                            \
+            thrown = true;                                                              \
+        } catch (...) {                                                                 \
+        }                                                                               \
+        ::term_test::record(thrown, __FILE__, __LINE__, #expr " throws " #E);           \
+    } while (false)
+
+// Prints "Summary: passed/run checks passed." and returns the process exit status.
+inline int testSummary() {
+    const auto& state = ::term_test::counts();
+    std::cout << "Summary: " << state.run - state.failed << "/" << state.run
+              << " checks passed.\n";
+    return state.failed == 0 ? 0 : 1;
+}
+
+#endif // TERM_TEST_H
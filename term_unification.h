@@ -1,14 +1,29 @@
 #ifndef TERM_UNIFICATION_H
 #define TERM_UNIFICATION_H
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "term_symbols.h"
+
+// Concrete kind of a term, stored in every node so dispatch needs no RTTI.
+enum class TermKind : std::uint8_t { Variable, Constant, Compound };
+
 // Base interface for all term types.
 // T is the stored value type (string for this assignment).
 template <typename T>
@@ -16,33 +31,50 @@ class Term {
 public:
     virtual ~Term() = default;
 
+    // Kind tag set by the concrete class; switch on this instead of casting.
+    TermKind kind() const noexcept;
+
     // True when this term is a logic variable placeholder (e.g., "X").
-    virtual bool isVariable() const = 0;
+    bool isVariable() const noexcept;
 
     // True when this term is a ground symbol with no structure (e.g., "a").
-    virtual bool isConstant() const = 0;
+    bool isConstant() const noexcept;
 
     // True when this term is a structured functor with arguments (e.g., f(X, Y)).
-    virtual bool isCompound() const = 0;
+    bool isCompound() const noexcept;
 
     // Clone enables deep copies during substitution/unification.
     virtual std::unique_ptr<Term<T>> clone() const = 0;
+
+protected:
+    explicit Term(TermKind kind) noexcept;
+    Term(const Term&) = default;
+    Term& operator=(const Term&) = default;
+
+private:
+    TermKind kind_;
 };
 
 // ------------------------------- Variable ---------------------------------
 class Variable : public Term<std::string> {
 private:
-    std::string name_;
+    const std::string* name_;  // owned by SymbolRegistry
+    SymbolId id_;
 
 public:
-    explicit Variable(std::string name);
+    static constexpr TermKind kKind = TermKind::Variable;
+
+    // Interns name; the node keeps only the registry's copy, so it holds no text itself.
+    explicit Variable(std::string_view name);
+
+    // Wraps a name the registry has interned already, e.g. SymbolRegistry::freshVariable().
+    explicit Variable(const SymbolRegistry::InternedSymbol& symbol) noexcept;
 
     // Returns the variable identifier (e.g., "X").
     const std::string& name() const noexcept;
 
-    bool isVariable() const override;
-    bool isConstant() const override;
-    bool isCompound() const override;
+    // Process-wide ID of name() (see SymbolRegistry); equal names have equal IDs.
+    SymbolId id() const noexcept;
 
     std::unique_ptr<Term<std::string>> clone() const override;
 };
@@ -50,197 +82,993 @@ public:
 // ------------------------------- Constant ---------------------------------
 class Constant : public Term<std::string> {
 private:
-    std::string value_;
+    const std::string* value_;  // owned by SymbolRegistry
+    SymbolId id_;
 
 public:
-    explicit Constant(std::string value);
+    static constexpr TermKind kKind = TermKind::Constant;
+
+    // Interns value like Variable does its name.
+    explicit Constant(std::string_view value);
 
     // Returns the stored symbol (e.g., "a").
     const std::string& value() const noexcept;
 
-    bool isVariable() const override;
-    bool isConstant() const override;
-    bool isCompound() const override;
+    // Process-wide ID of value(), shared with functors of the same text.
+    SymbolId id() const noexcept;
 
     std::unique_ptr<Term<std::string>> clone() const override;
 };
 
 // ------------------------------- Compound ---------------------------------
+// Node layout: the functor text lives in SymbolRegistry, and up to kInlineArity
+// arguments are stored inside the node, so a small compound is a single allocation.
 template <typename T>
 class Compound : public Term<T> {
-private:
-    std::string functor_;
-    std::vector<std::unique_ptr<Term<T>>> args_;
-
 public:
     using TermPtr = std::unique_ptr<Term<T>>;
 
-    Compound(std::string functor, std::vector<TermPtr> args);
+    static constexpr TermKind kKind = TermKind::Compound;
+
+    // Largest arity kept inline; wider compounds take one extra array allocation.
+    static constexpr std::size_t kInlineArity = 4;
+
+    Compound(std::string_view functor, std::vector<TermPtr> args);
     Compound(const Compound& other);
     Compound& operator=(const Compound& other);
-    Compound(Compound&& other) noexcept = default;
-    Compound& operator=(Compound&& other) noexcept = default;
-    ~Compound() override = default;
+    Compound(Compound&& other) noexcept;
+    Compound& operator=(Compound&& other) noexcept;
+    ~Compound() override;
+
+    // Builds functor(args...) by moving each argument straight into the node, without a
+    // temporary vector. Every argument must convert to TermPtr.
+    template <typename... Args>
+    static std::unique_ptr<Compound> make(std::string_view functor, Args&&... args);
+
+    // Same for arguments already collected in a buffer: moves args[0 .. count) into the node.
+    static std::unique_ptr<Compound> makeFrom(std::string_view functor,
+                                              TermPtr* args,
+                                              std::size_t count);
+
+    // Same with a functor the registry has interned already (see symbol()).
+    static std::unique_ptr<Compound> makeFrom(SymbolRegistry::InternedSymbol functor,
+                                              TermPtr* args,
+                                              std::size_t count);
 
     // Functor name (e.g., "f" in f(X, Y)).
     const std::string& functor() const noexcept;
 
+    // Process-wide ID of functor(), shared with constants of the same text.
+    SymbolId functorId() const noexcept;
+
+    // functorId() and functor() together, for building nodes without interning again.
+    SymbolRegistry::InternedSymbol symbol() const noexcept;
+
     // Number of child terms.
     std::size_t arity() const noexcept;
 
     // Access the i-th child term (throws std::out_of_range on bad index).
     const Term<T>& arg(std::size_t index) const;
 
-    bool isVariable() const override;
-    bool isConstant() const override;
-    bool isCompound() const override;
-
     std::unique_ptr<Term<T>> clone() const override;
 
 private:
-    static std::vector<TermPtr> cloneArgs(const std::vector<TermPtr>& src);
+    const std::string* functor_;  // owned by SymbolRegistry
+    SymbolId functorId_;
+    std::uint32_t arity_;
+    TermPtr inline_[kInlineArity];
+    std::unique_ptr<TermPtr[]> spilled_;  // arguments when arity_ > kInlineArity
+
+    // Compound with the given functor and arity whose arguments are still null.
+    Compound(SymbolRegistry::InternedSymbol functor, std::size_t arity);
+
+    TermPtr* slots() noexcept;
+    const TermPtr* slots() const noexcept;
+
+    // Moves other's arguments into this (empty) node and leaves other with arity 0.
+    void take(Compound& other) noexcept;
+
+    // Releases every argument subtree without recursing once per level.
+    void destroyArgs() noexcept;
+};
+
+// ------------------------------- Dispatch ---------------------------------
+// Unchecked downcast for callers that already know the kind (asserted in debug builds).
+template <typename To, typename T>
+const To& termCast(const Term<T>& term) noexcept;
+
+// Borrowed view of a string term as its concrete type, for use with std::visit.
+using TermVariant =
+    std::variant<const Variable*, const Constant*, const Compound<std::string>*>;
+
+TermVariant asVariant(const Term<std::string>& term) noexcept;
+
+// Calls visitor with const Variable&, const Constant& or const Compound<std::string>&
+// by switching on kind(); every overload must return the same type.
+template <typename Visitor>
+decltype(auto) visitTerm(const Term<std::string>& term, Visitor&& visitor);
+
+// Pairs of subterms still to compare in identical().
+using TermPairStack = std::vector<std::pair<const Term<std::string>*, const Term<std::string>*>>;
+
+// Structural equality, with no bindings applied: same shape, symbols and variables.
+// pending is the work stack, cleared on entry; pass one to reuse it across calls.
+bool identical(const Term<std::string>& a, const Term<std::string>& b, TermPairStack& pending);
+bool identical(const Term<std::string>& a, const Term<std::string>& b);
+
+// ------------------------------ TermCloner --------------------------------
+// Iterative post-order construction of a pointer-based term from any tree-shaped source:
+// a Term, a TermStore or TermImage node ID, a FlatHeap cell, a renamed term. The caller's
+// visit(node, step) describes one node, either as a finished leaf or as a compound whose
+// children it names in order; finished subterms collect on a stack until their parent
+// takes them, so depth is bounded by memory rather than the call stack.
+// The stacks are kept across calls, so a cloner held by its owner builds without
+// allocating for them once grown. Not reentrant: visit must not call build() on the
+// same cloner.
+template <typename Node>
+class TermCloner {
+public:
+    using TermPtr = std::unique_ptr<Term<std::string>>;
+
+    // What visit() reports about one node: exactly one leaf(), or one compound() followed
+    // by arity child() calls, leftmost first.
+    class Step {
+    public:
+        void leaf(TermPtr term);
+
+        // A compound with the functor of shape (not interned again) or with the given
+        // functor text.
+        void compound(const Compound<std::string>& shape);
+        void compound(std::string_view functor, std::size_t arity);
+        void compound(SymbolRegistry::InternedSymbol functor, std::size_t arity);
+
+        void child(const Node& node);
+
+    private:
+        friend class TermCloner;
+
+        explicit Step(TermCloner& owner) noexcept;
+
+        TermCloner& owner_;
+        std::size_t firstChild_;
+    };
+
+    TermCloner() = default;
+
+    // Term built from root. visit is called as visit(const Node&, Step&) for every node
+    // in preorder, leftmost child first.
+    template <typename Visit>
+    TermPtr build(const Node& root, Visit&& visit);
+
+private:
+    // A node to visit, or (expanded) a compound to assemble from the last arity
+    // finished children.
+    struct Task {
+        Node node;
+        SymbolRegistry::InternedSymbol functor;
+        std::uint32_t arity;
+        bool expanded;
+    };
+
+    std::vector<Task> tasks_;
+    std::vector<TermPtr> done_;
+    const Node* current_ = nullptr;  // node being visited, for Step::compound
+};
+
+// ------------------------------- Bindings ---------------------------------
+// Triangular substitution: each variable maps to a non-owning reference to the term it
+// was bound to, which may itself mention bound variables. Nothing is copied when binding;
+// chains are followed on demand with path compression (union-find "find").
+// Values point into the unified terms, so those must outlive the Bindings.
+// Storage is an open-addressing table keyed by Variable::id(), sized by the number of
+// variables bound rather than by how large their IDs are, and comes from the given memory
+// resource (e.g. a TermArena). Reusing one Bindings across calls (clear() between them)
+// avoids regrowing it.
+// Every change is recorded on a trail, so any state reached earlier can be restored
+// with undoTo(mark()) in time proportional to the changes made since.
+class Bindings {
+private:
+    // Value of one variable ID; variable is the node the binding was made through.
+    struct Slot {
+        SymbolId id;
+        const Variable* variable;
+        const Term<std::string>* value;
+    };
+
+    // Previous value of one slot; nullptr means the variable was unbound.
+    struct TrailEntry {
+        SymbolId id;
+        const Term<std::string>* previous;
+    };
+
+    static constexpr SymbolId kEmpty = ~SymbolId{0};
+
+    std::pmr::vector<Slot> slots_;  // capacity is 0 or a power of two
+    std::pmr::vector<SymbolId> bound_;  // IDs with a value, in the order they were bound
+    std::pmr::vector<TrailEntry> trail_;
+
+    std::size_t home(SymbolId id) const noexcept;
+    Slot* find(SymbolId id) noexcept;
+    const Slot* find(SymbolId id) const noexcept;
+    void grow();
+    void erase(SymbolId id) noexcept;
+
+public:
+    // Trail position returned by mark().
+    using Mark = std::size_t;
+
+    // Visits (variable, value) pairs in the order the variables were bound.
+    class const_iterator {
+    public:
+        using value_type = std::pair<const Variable*, const Term<std::string>*>;
+        using reference = value_type;
+        using pointer = void;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+
+        value_type operator*() const noexcept;
+        const_iterator& operator++() noexcept;
+        bool operator==(const const_iterator& other) const noexcept;
+        bool operator!=(const const_iterator& other) const noexcept;
+
+    private:
+        friend class Bindings;
+
+        const_iterator(const Bindings* owner, std::size_t index) noexcept;
+
+        const Bindings* owner_;
+        std::size_t index_;
+    };
+
+    explicit Bindings(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Direct binding of a variable (no chain following), or nullptr when unbound.
+    const Term<std::string>* lookup(const Variable& var) const noexcept;
+
+    // Follows bindings from term until reaching a non-variable or an unbound variable.
+    // Every variable passed on the way is re-pointed at the result.
+    const Term<std::string>& resolve(const Term<std::string>& term);
+
+    // Same as resolve without path compression, for read-only callers.
+    const Term<std::string>& resolve(const Term<std::string>& term) const;
+
+    // Binds var to value; var must outlive the Bindings, since iteration hands it back.
+    void bind(const Variable& var, const Term<std::string>& value);
+
+    // Current trail position.
+    Mark mark() const noexcept;
+
+    // Reverts every bind (and path compression) made since m was taken.
+    void undoTo(Mark m);
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    // Drops all bindings and the trail in time proportional to the bound variables,
+    // keeping the storage; earlier marks become invalid.
+    void clear() noexcept;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
 };
 
 // ------------------------------- Unifier ----------------------------------
+class TermArena;
+
+// When the unifier rejects bindings that would make a term contain itself (X = f(X)).
+enum class OccursCheck : std::uint8_t {
+    Full,      // check every binding as it is made (default)
+    None,      // never check; only for inputs known not to form cycles
+    Deferred,  // acyclicity passes over the bindings: one after unification succeeds, and
+               // a few while a long one runs, so a cycle fails it instead of looping
+};
+
+// Hot-path counters of one Unifier. They are only collected when the library is built
+// with TERM_UNIFICATION_STATS defined; otherwise the counting compiles away and every
+// field stays 0. The layout is the same either way, so callers need not define it.
+struct UnifierStats {
+    std::size_t steps = 0;         // term pairs taken off the unify/match work stack
+    std::size_t bindings = 0;      // variables bound
+    std::size_t occursVisits = 0;  // nodes visited by occurs and acyclicity checks
+    std::size_t clonedNodes = 0;   // nodes built for results and substitute()
+
+    // Failures by reason.
+    std::size_t constantMismatches = 0;  // two different constants
+    std::size_t functorMismatches = 0;   // compounds with different functors
+    std::size_t arityMismatches = 0;     // same functor, different arity
+    std::size_t kindMismatches = 0;      // constant vs compound, or a rigid match variable
+    std::size_t occursFailures = 0;      // a binding would have made a cycle
+    std::size_t repeatMismatches = 0;    // a repeated match variable met different subterms
+};
+
 class Unifier {
 public:
     using Substitution = std::map<std::string, std::unique_ptr<Term<std::string>>>;
 
+    // Structure-sharing result: keys and values point into the unified terms, so nothing
+    // is copied and the result is only valid while those terms live. Values are
+    // triangular like Bindings (they may mention other bound variables).
+    using SharedSubstitution = std::map<std::string_view, const Term<std::string>*>;
+
+    // One equation of a conjunction passed to unifyAll() / unifyInto().
+    using TermPair = std::pair<const Term<std::string>*, const Term<std::string>*>;
+
+    Unifier() = default;
+
+    // Takes the scratch bindings of unify() and match() from arena instead of the heap.
+    // They are reused across calls, so once grown, calls that fail allocate nothing.
+    // The arena must outlive the Unifier and must not be rewound while it is in use.
+    explicit Unifier(TermArena& arena) noexcept;
+
+    // Occurs-check policy used by later unify() calls.
+    void setOccursCheck(OccursCheck policy) noexcept;
+    OccursCheck occursCheck() const noexcept;
+
+    // Snapshot of the counters since construction or the last resetStats().
+    UnifierStats stats() const noexcept;
+    void resetStats() noexcept;
+
     // Attempts to unify t1 and t2. Returns std::nullopt on failure.
     // On success, returns variable bindings such that applying them makes t1 and t2 identical.
+    // Every value is fully applied (no value mentions a bound variable).
     std::optional<Substitution> unify(const Term<std::string>& t1,
                                       const Term<std::string>& t2);
 
+    // Same unifier as unify(t1, t2), with every value left as a reference into t1 or t2
+    // (so values are triangular, see SharedSubstitution).
+    std::optional<SharedSubstitution> unifyShared(const Term<std::string>& t1,
+                                                  const Term<std::string>& t2);
+
+    // Lazy variant: extends bindings with the unifier of t1 and t2, recorded as references
+    // into the terms without copying anything. On failure bindings are rolled back to their
+    // state on entry, so a caller can keep trying alternatives against the same bindings.
+    bool unify(const Term<std::string>& t1,
+               const Term<std::string>& t2,
+               Bindings& bindings);
+
+    // Unifier of every pair at once (a conjunction of equations), or std::nullopt if any
+    // pair fails under the bindings of the pairs before it.
+    std::optional<Substitution> unifyAll(const std::vector<TermPair>& pairs);
+
+    // Extends sub in place with the unifier of t1 and t2 under the bindings already in sub
+    // (which may be triangular). Existing entries are never changed; new entries are deep
+    // copies with sub and the new bindings applied. On failure returns false and leaves
+    // sub untouched.
+    bool unifyInto(const Term<std::string>& t1,
+                   const Term<std::string>& t2,
+                   Substitution& sub);
+
+    // Same for a conjunction: either every pair is added to sub or nothing is.
+    bool unifyInto(const std::vector<TermPair>& pairs, Substitution& sub);
+
+    // One-way matching: binds only pattern variables so that applying the result to pattern
+    // yields subject exactly. Subject variables are rigid (treated like constants), the
+    // subject is never copied while matching, and no occurs check is needed.
+    // Returns std::nullopt when subject is not an instance of pattern.
+    std::optional<Substitution> match(const Term<std::string>& pattern,
+                                      const Term<std::string>& subject);
+
+    // Same matcher as match(pattern, subject), with every value a subterm of subject.
+    std::optional<SharedSubstitution> matchShared(const Term<std::string>& pattern,
+                                                  const Term<std::string>& subject);
+
+    // Lazy variant with the same extend-or-roll-back contract as unify(t1, t2, bindings).
+    // Bound values point into subject; pattern and subject should not share variable names
+    // if the bindings will be passed to substitute().
+    bool match(const Term<std::string>& pattern,
+               const Term<std::string>& subject,
+               Bindings& bindings);
+
     // Applies a substitution to a term, returning a deep copy with bindings applied.
     // Input: any term plus a substitution map. Output: fully substituted term (new heap object).
     std::unique_ptr<Term<std::string>> substitute(const Term<std::string>& term,
                                                   const Substitution& sub) const;
 
+    // Same for lazy bindings; this is the only point where the applied term is built.
+    std::unique_ptr<Term<std::string>> substitute(const Term<std::string>& term,
+                                                  const Bindings& bindings) const;
+
+    // Same for a shared result.
+    std::unique_ptr<Term<std::string>> substitute(const Term<std::string>& term,
+                                                  const SharedSubstitution& sub) const;
+
+    // Owned copy of a shared result with every value fully applied, giving exactly what
+    // unify() or match() would have returned (for match, as long as pattern and subject
+    // share no variable names).
+    Substitution toOwned(const SharedSubstitution& shared) const;
+
 private:
-    // Occurs check: returns true if varName appears anywhere inside term after applying sub.
-    // Used to prevent circular bindings.
-    bool occurs(const std::string& varName,
+    OccursCheck occursCheck_ = OccursCheck::Full;
+    mutable UnifierStats stats_;  // written only when TERM_UNIFICATION_STATS is defined
+
+    // Work stacks and the bindings behind unify() and match(), reused across calls so
+    // steady-state calls do not allocate for them.
+    // They make a Unifier unsafe to share between threads, even through const methods.
+    Bindings scratch_;
+    std::vector<std::pair<const Term<std::string>*, const Term<std::string>*>> pairs_;
+    TermPairStack equalPairs_;
+    mutable std::vector<const Term<std::string>*> scan_;
+    mutable TermCloner<const Term<std::string>*> cloner_;
+    std::vector<std::pair<const Term<std::string>*, SymbolId>> cycleScan_;
+    std::unordered_map<SymbolId, bool> cycleDone_;  // false while on the DFS path
+    std::vector<Variable> seedVariables_;  // keys of the substitution given to unifyInto()
+
+    // Occurs check: returns true if the variable varId appears anywhere inside term after
+    // applying bindings. Used to prevent circular bindings.
+    bool occurs(SymbolId varId,
                 const Term<std::string>& term,
-                const Substitution& sub) const;
+                Bindings& bindings) const;
+
+    // One-way matching driver over pairs_; extends 'working' with pattern bindings.
+    bool matchInternal(const Term<std::string>& pattern,
+                       const Term<std::string>& subject,
+                       Bindings& working);
 
-    // Helper: clone term while applying sub recursively.
+    // Deferred occurs check: true when no variable reaches itself through its bindings.
+    bool acyclic(const Bindings& bindings);
+
+    // Helper: clone term while applying sub to every variable.
     std::unique_ptr<Term<std::string>> cloneWithSubstitution(const Term<std::string>& term,
                                                              const Substitution& sub) const;
 
-    // Recursive unification driver; returns true on success and mutates 'working'.
-    // Expects both terms to be partially substituted already.
+    // Shared driver of unifyAll() and unifyInto(): loads sub into scratch_, unifies every
+    // pair and on success adds the new bindings to sub.
+    bool extend(const TermPair* pairs, std::size_t count, Substitution& sub);
+
+    // Result builders for the one-shot calls: resolveOut applies the bindings to every
+    // value (unify), copyOut copies values as they are (match, whose values are subject
+    // subterms).
+    Substitution resolveOut(const Bindings& bindings) const;
+    Substitution copyOut(const Bindings& bindings) const;
+    static SharedSubstitution shareOut(const Bindings& bindings);
+
+    // Helper: clone term while resolving bindings on every variable.
+    std::unique_ptr<Term<std::string>> cloneWithBindings(const Term<std::string>& term,
+                                                         const Bindings& bindings) const;
+
+    // Shared iterative clone; resolve(term) maps each visited term to the one to copy.
+    template <typename Resolve>
+    std::unique_ptr<Term<std::string>> cloneResolved(const Term<std::string>& term,
+                                                     Resolve resolve) const;
+
+    // Unification driver over an explicit stack of term pairs; returns true on success
+    // and extends 'working'. Terms are resolved against the bindings as they are visited,
+    // never copied. Visits pairs in the same depth-first, left-to-right order as recursion.
     bool unifyInternal(const Term<std::string>& a,
                        const Term<std::string>& b,
-                       Substitution& working);
+                       Bindings& working);
 };
 
 // ------------------------- Inline Implementations ------------------------
 
-inline Variable::Variable(std::string name) : name_(std::move(name)) {}
+inline void Unifier::setOccursCheck(OccursCheck policy) noexcept {
+    occursCheck_ = policy;
+}
+
+inline OccursCheck Unifier::occursCheck() const noexcept {
+    return occursCheck_;
+}
 
-inline const std::string& Variable::name() const noexcept {
-    return name_;
+inline UnifierStats Unifier::stats() const noexcept {
+    return stats_;
 }
 
-inline bool Variable::isVariable() const {
-    return true;
+inline void Unifier::resetStats() noexcept {
+    stats_ = UnifierStats();
 }
 
-inline bool Variable::isConstant() const {
-    return false;
+template <typename T>
+inline Term<T>::Term(TermKind kind) noexcept : kind_(kind) {}
+
+template <typename T>
+inline TermKind Term<T>::kind() const noexcept {
+    return kind_;
 }
 
-inline bool Variable::isCompound() const {
-    return false;
+template <typename T>
+inline bool Term<T>::isVariable() const noexcept {
+    return kind_ == TermKind::Variable;
+}
+
+template <typename T>
+inline bool Term<T>::isConstant() const noexcept {
+    return kind_ == TermKind::Constant;
+}
+
+template <typename T>
+inline bool Term<T>::isCompound() const noexcept {
+    return kind_ == TermKind::Compound;
+}
+
+inline Variable::Variable(std::string_view name) : Term<std::string>(kKind) {
+    const SymbolRegistry::InternedSymbol symbol = SymbolRegistry::internVariable(name);
+    name_ = symbol.text;
+    id_ = symbol.id;
+}
+
+inline Variable::Variable(const SymbolRegistry::InternedSymbol& symbol) noexcept
+    : Term<std::string>(kKind), name_(symbol.text), id_(symbol.id) {}
+
+inline const std::string& Variable::name() const noexcept {
+    return *name_;
+}
+
+inline SymbolId Variable::id() const noexcept {
+    return id_;
 }
 
 inline std::unique_ptr<Term<std::string>> Variable::clone() const {
-    return std::make_unique<Variable>(name_);
+    return std::make_unique<Variable>(*this);
 }
 
-inline Constant::Constant(std::string value) : value_(std::move(value)) {}
+inline Constant::Constant(std::string_view value) : Term<std::string>(kKind) {
+    const SymbolRegistry::InternedSymbol symbol = SymbolRegistry::internAtom(value);
+    value_ = symbol.text;
+    id_ = symbol.id;
+}
 
 inline const std::string& Constant::value() const noexcept {
-    return value_;
+    return *value_;
+}
+
+inline SymbolId Constant::id() const noexcept {
+    return id_;
 }
 
-inline bool Constant::isVariable() const {
-    return false;
+inline std::unique_ptr<Term<std::string>> Constant::clone() const {
+    return std::make_unique<Constant>(*this);
 }
 
-inline bool Constant::isConstant() const {
-    return true;
+template <typename To, typename T>
+inline const To& termCast(const Term<T>& term) noexcept {
+    assert(term.kind() == To::kKind);
+    return static_cast<const To&>(term);
 }
 
-inline bool Constant::isCompound() const {
-    return false;
+inline TermVariant asVariant(const Term<std::string>& term) noexcept {
+    switch (term.kind()) {
+    case TermKind::Variable:
+        return &termCast<Variable>(term);
+    case TermKind::Constant:
+        return &termCast<Constant>(term);
+    case TermKind::Compound:
+        break;
+    }
+    return &termCast<Compound<std::string>>(term);
 }
 
-inline std::unique_ptr<Term<std::string>> Constant::clone() const {
-    return std::make_unique<Constant>(value_);
+inline bool identical(const Term<std::string>& a, const Term<std::string>& b) {
+    TermPairStack pending;
+    return identical(a, b, pending);
+}
+
+template <typename Visitor>
+inline decltype(auto) visitTerm(const Term<std::string>& term, Visitor&& visitor) {
+    switch (term.kind()) {
+    case TermKind::Variable:
+        return visitor(termCast<Variable>(term));
+    case TermKind::Constant:
+        return visitor(termCast<Constant>(term));
+    case TermKind::Compound:
+        break;
+    }
+    return visitor(termCast<Compound<std::string>>(term));
+}
+
+inline Bindings::const_iterator::const_iterator(const Bindings* owner,
+                                                std::size_t index) noexcept
+    : owner_(owner), index_(index) {}
+
+inline Bindings::const_iterator::value_type Bindings::const_iterator::operator*() const noexcept {
+    const Slot* slot = owner_->find(owner_->bound_[index_]);
+    return value_type(slot->variable, slot->value);
+}
+
+inline Bindings::const_iterator& Bindings::const_iterator::operator++() noexcept {
+    ++index_;
+    return *this;
+}
+
+inline bool Bindings::const_iterator::operator==(const const_iterator& other) const noexcept {
+    return index_ == other.index_ && owner_ == other.owner_;
+}
+
+inline bool Bindings::const_iterator::operator!=(const const_iterator& other) const noexcept {
+    return !(*this == other);
+}
+
+inline Bindings::Bindings(std::pmr::memory_resource* resource)
+    : slots_(resource), bound_(resource), trail_(resource) {}
+
+inline std::size_t Bindings::home(SymbolId id) const noexcept {
+    return static_cast<std::size_t>(id * 0x9e3779b9u) & (slots_.size() - 1);
+}
+
+inline Bindings::Slot* Bindings::find(SymbolId id) noexcept {
+    return const_cast<Slot*>(static_cast<const Bindings&>(*this).find(id));
+}
+
+inline const Bindings::Slot* Bindings::find(SymbolId id) const noexcept {
+    if (bound_.empty()) {
+        return nullptr;
+    }
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = home(id);; i = (i + 1) & mask) {
+        if (slots_[i].id == id) {
+            return &slots_[i];
+        }
+        if (slots_[i].id == kEmpty) {
+            return nullptr;
+        }
+    }
+}
+
+inline const Term<std::string>* Bindings::lookup(const Variable& var) const noexcept {
+    const Slot* slot = find(var.id());
+    return slot != nullptr ? slot->value : nullptr;
+}
+
+inline const Term<std::string>& Bindings::resolve(const Term<std::string>& term) {
+    const Term<std::string>& root = static_cast<const Bindings&>(*this).resolve(term);
+    // second pass: point every variable on the chain straight at the root
+    const Term<std::string>* current = &term;
+    while (current != &root && current->isVariable()) {
+        const SymbolId id = termCast<Variable>(*current).id();
+        Slot& slot = *find(id);
+        current = slot.value;
+        if (slot.value != &root) {
+            trail_.push_back(TrailEntry{id, slot.value});
+            slot.value = &root;
+        }
+    }
+    return root;
+}
+
+inline const Term<std::string>& Bindings::resolve(const Term<std::string>& term) const {
+    const Term<std::string>* current = &term;
+    while (current->isVariable()) {
+        const Term<std::string>* next = lookup(termCast<Variable>(*current));
+        if (next == nullptr) {
+            break;
+        }
+        current = next;
+    }
+    return *current;
+}
+
+inline void Bindings::bind(const Variable& var, const Term<std::string>& value) {
+    const SymbolId id = var.id();
+    Slot* slot = find(id);
+    if (slot == nullptr) {
+        if ((bound_.size() + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t i = home(id);
+        while (slots_[i].id != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        slot = &slots_[i];
+        *slot = Slot{id, &var, nullptr};
+        bound_.push_back(id);
+    }
+    trail_.push_back(TrailEntry{id, slot->value});
+    slot->value = &value;
+}
+
+inline Bindings::Mark Bindings::mark() const noexcept {
+    return trail_.size();
+}
+
+inline void Bindings::undoTo(Mark m) {
+    while (trail_.size() > m) {
+        const TrailEntry& entry = trail_.back();
+        if (entry.previous == nullptr) {
+            // fresh binds are undone in reverse order, so this is always the last one
+            erase(entry.id);
+            bound_.pop_back();
+        } else {
+            find(entry.id)->value = entry.previous;
+        }
+        trail_.pop_back();
+    }
+}
+
+inline std::size_t Bindings::size() const noexcept {
+    return bound_.size();
+}
+
+inline bool Bindings::empty() const noexcept {
+    return bound_.empty();
+}
+
+inline void Bindings::clear() noexcept {
+    while (!bound_.empty()) {
+        erase(bound_.back());
+        bound_.pop_back();
+    }
+    trail_.clear();
+}
+
+inline Bindings::const_iterator Bindings::begin() const noexcept {
+    return const_iterator(this, 0);
+}
+
+inline Bindings::const_iterator Bindings::end() const noexcept {
+    return const_iterator(this, bound_.size());
+}
+
+template <typename T>
+inline Compound<T>::Compound(SymbolRegistry::InternedSymbol functor, std::size_t arity)
+    : Term<T>(kKind),
+      functor_(functor.text),
+      functorId_(functor.id),
+      arity_(static_cast<std::uint32_t>(arity)),
+      spilled_(arity > kInlineArity ? std::make_unique<TermPtr[]>(arity) : nullptr) {}
+
+template <typename T>
+inline Compound<T>::Compound(std::string_view functor, std::vector<TermPtr> args)
+    : Compound(SymbolRegistry::internAtom(functor), args.size()) {
+    std::move(args.begin(), args.end(), slots());
+}
+
+template <typename T>
+template <typename... Args>
+inline std::unique_ptr<Compound<T>> Compound<T>::make(std::string_view functor, Args&&... args) {
+    static_assert((std::is_convertible_v<Args&&, TermPtr> && ...),
+                  "Compound::make arguments must convert to TermPtr");
+    std::unique_ptr<Compound> node(
+        new Compound(SymbolRegistry::internAtom(functor), sizeof...(Args)));
+    [[maybe_unused]] TermPtr* out = node->slots();
+    ((*out++ = TermPtr(std::forward<Args>(args))), ...);
+    return node;
+}
+
+template <typename T>
+inline std::unique_ptr<Compound<T>> Compound<T>::makeFrom(std::string_view functor,
+                                                          TermPtr* args,
+                                                          std::size_t count) {
+    return makeFrom(SymbolRegistry::internAtom(functor), args, count);
 }
 
 template <typename T>
-inline Compound<T>::Compound(std::string functor, std::vector<TermPtr> args)
-    : functor_(std::move(functor)), args_(std::move(args)) {}
+inline std::unique_ptr<Compound<T>> Compound<T>::makeFrom(SymbolRegistry::InternedSymbol functor,
+                                                          TermPtr* args,
+                                                          std::size_t count) {
+    std::unique_ptr<Compound> node(new Compound(functor, count));
+    std::move(args, args + count, node->slots());
+    return node;
+}
 
 template <typename T>
 inline Compound<T>::Compound(const Compound& other)
-    : functor_(other.functor_), args_(cloneArgs(other.args_)) {}
+    : Compound(other.symbol(), other.arity_) {
+    // nested compounds are copied from an explicit list of (source, copy) nodes, so deep
+    // terms do not take one constructor frame per level
+    std::vector<std::pair<const Compound*, Compound*>> pending{{&other, this}};
+    while (!pending.empty()) {
+        const auto [source, copy] = pending.back();
+        pending.pop_back();
+        const TermPtr* from = source->slots();
+        TermPtr* to = copy->slots();
+        for (std::size_t i = 0; i < source->arity_; ++i) {
+            if (!from[i]->isCompound()) {
+                to[i] = from[i]->clone();
+                continue;
+            }
+            const auto& child = static_cast<const Compound&>(*from[i]);
+            std::unique_ptr<Compound> node(new Compound(child.symbol(), child.arity_));
+            pending.emplace_back(&child, node.get());
+            to[i] = std::move(node);
+        }
+    }
+}
 
 template <typename T>
 inline Compound<T>& Compound<T>::operator=(const Compound& other) {
     if (this != &other) {
+        Compound copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template <typename T>
+inline Compound<T>::Compound(Compound&& other) noexcept
+    : Term<T>(other), functor_(other.functor_), functorId_(other.functorId_), arity_(0) {
+    take(other);
+}
+
+template <typename T>
+inline Compound<T>& Compound<T>::operator=(Compound&& other) noexcept {
+    if (this != &other) {
+        destroyArgs();
         functor_ = other.functor_;
-        args_ = cloneArgs(other.args_);
+        functorId_ = other.functorId_;
+        take(other);
     }
     return *this;
 }
 
 template <typename T>
-inline const std::string& Compound<T>::functor() const noexcept {
-    return functor_;
+inline Compound<T>::~Compound() {
+    destroyArgs();
 }
 
 template <typename T>
-inline std::size_t Compound<T>::arity() const noexcept {
-    return args_.size();
+inline void Compound<T>::take(Compound& other) noexcept {
+    arity_ = std::exchange(other.arity_, 0);
+    spilled_ = std::move(other.spilled_);
+    for (std::size_t i = 0; i < kInlineArity; ++i) {
+        inline_[i] = std::move(other.inline_[i]);
+    }
 }
 
 template <typename T>
-inline const Term<T>& Compound<T>::arg(std::size_t index) const {
-    return *args_.at(index);
+inline void Compound<T>::destroyArgs() noexcept {
+    // tear nested compounds down from a flat list so long chains (e.g. 100k cons cells)
+    // do not take one destructor frame per level; leaf-only nodes need no list at all
+    TermPtr* own = slots();
+    bool nested = false;
+    for (std::size_t i = 0; i < arity_ && !nested; ++i) {
+        nested = own[i] != nullptr && own[i]->isCompound();
+    }
+    if (nested) {
+        std::vector<TermPtr> pending(std::make_move_iterator(own),
+                                     std::make_move_iterator(own + arity_));
+        while (!pending.empty()) {
+            TermPtr node = std::move(pending.back());
+            pending.pop_back();
+            if (node != nullptr && node->isCompound()) {
+                auto& comp = static_cast<Compound<T>&>(*node);
+                TermPtr* children = comp.slots();
+                for (std::size_t i = 0; i < comp.arity_; ++i) {
+                    pending.push_back(std::move(children[i]));
+                }
+                comp.arity_ = 0;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < kInlineArity; ++i) {
+        inline_[i].reset();
+    }
+    spilled_.reset();
+    arity_ = 0;
 }
 
 template <typename T>
-inline bool Compound<T>::isVariable() const {
-    return false;
+inline SymbolRegistry::InternedSymbol Compound<T>::symbol() const noexcept {
+    return SymbolRegistry::InternedSymbol{functorId_, functor_};
 }
 
 template <typename T>
-inline bool Compound<T>::isConstant() const {
-    return false;
+inline typename Compound<T>::TermPtr* Compound<T>::slots() noexcept {
+    return arity_ > kInlineArity ? spilled_.get() : inline_;
 }
 
 template <typename T>
-inline bool Compound<T>::isCompound() const {
-    return true;
+inline const typename Compound<T>::TermPtr* Compound<T>::slots() const noexcept {
+    return arity_ > kInlineArity ? spilled_.get() : inline_;
 }
 
 template <typename T>
-inline std::unique_ptr<Term<T>> Compound<T>::clone() const {
-    return std::make_unique<Compound<T>>(functor_, cloneArgs(args_));
+inline const std::string& Compound<T>::functor() const noexcept {
+    return *functor_;
+}
+
+template <typename T>
+inline SymbolId Compound<T>::functorId() const noexcept {
+    return functorId_;
+}
+
+template <typename T>
+inline std::size_t Compound<T>::arity() const noexcept {
+    return arity_;
+}
+
+template <typename T>
+inline const Term<T>& Compound<T>::arg(std::size_t index) const {
+    if (index >= arity_) {
+        throw std::out_of_range("Compound::arg index out of range");
+    }
+    return *slots()[index];
 }
 
 template <typename T>
-inline std::vector<typename Compound<T>::TermPtr> Compound<T>::cloneArgs(
-    const std::vector<TermPtr>& src) {
-    std::vector<TermPtr> copy;
-    copy.reserve(src.size());
-    for (const auto& arg : src) {
-        copy.push_back(arg->clone());
+inline std::unique_ptr<Term<T>> Compound<T>::clone() const {
+    return std::make_unique<Compound<T>>(*this);
+}
+
+
+template <typename Node>
+inline TermCloner<Node>::Step::Step(TermCloner& owner) noexcept
+    : owner_(owner), firstChild_(owner.tasks_.size()) {}
+
+template <typename Node>
+inline void TermCloner<Node>::Step::leaf(TermPtr term) {
+    owner_.done_.push_back(std::move(term));
+}
+
+template <typename Node>
+inline void TermCloner<Node>::Step::compound(const Compound<std::string>& shape) {
+    compound(shape.symbol(), shape.arity());
+}
+
+template <typename Node>
+inline void TermCloner<Node>::Step::compound(std::string_view functor, std::size_t arity) {
+    compound(SymbolRegistry::internAtom(functor), arity);
+}
+
+template <typename Node>
+inline void TermCloner<Node>::Step::compound(SymbolRegistry::InternedSymbol functor,
+                                             std::size_t arity) {
+    owner_.tasks_.push_back(
+        Task{*owner_.current_, functor, static_cast<std::uint32_t>(arity), true});
+    firstChild_ = owner_.tasks_.size();
+}
+
+template <typename Node>
+inline void TermCloner<Node>::Step::child(const Node& node) {
+    owner_.tasks_.push_back(Task{node, SymbolRegistry::InternedSymbol{0, nullptr}, 0, false});
+}
+
+template <typename Node>
+template <typename Visit>
+inline typename TermCloner<Node>::TermPtr TermCloner<Node>::build(const Node& root,
+                                                                  Visit&& visit) {
+    tasks_.clear();
+    done_.clear();
+    tasks_.push_back(Task{root, SymbolRegistry::InternedSymbol{0, nullptr}, 0, false});
+    while (!tasks_.empty()) {
+        Task task = std::move(tasks_.back());
+        tasks_.pop_back();
+
+        if (task.expanded) {
+            const std::size_t first = done_.size() - task.arity;
+            auto node = Compound<std::string>::makeFrom(task.functor, done_.data() + first,
+                                                        task.arity);
+            done_.resize(first);
+            done_.push_back(std::move(node));
+            continue;
+        }
+
+        current_ = &task.node;
+        Step step(*this);
+        visit(static_cast<const Node&>(task.node), step);
+        // children were named leftmost first; flip them so the leftmost is taken first
+        std::reverse(tasks_.begin() + static_cast<std::ptrdiff_t>(step.firstChild_),
+                     tasks_.end());
     }
-    return copy;
+    current_ = nullptr;
+    TermPtr result = std::move(done_.back());
+    done_.clear();
+    return result;
+}
+
+// ------------------------------- Builders ---------------------------------
+// Library term factories. compound() moves its arguments straight into the node, so
+// building f(X, a) allocates the three nodes and nothing else.
+namespace builders {
+
+inline std::unique_ptr<Term<std::string>> var(std::string name) {
+    return std::make_unique<Variable>(std::move(name));
 }
 
+inline std::unique_ptr<Term<std::string>> constant(std::string value) {
+    return std::make_unique<Constant>(std::move(value));
+}
+
+template <typename... Args>
+inline std::unique_ptr<Term<std::string>> compound(std::string_view functor, Args&&... args) {
+    return Compound<std::string>::make(functor, std::forward<Args>(args)...);
+}
+
+// For arguments collected at run time.
+inline std::unique_ptr<Term<std::string>> compound(
+    std::string_view functor, std::vector<std::unique_ptr<Term<std::string>>> args) {
+    return std::make_unique<Compound<std::string>>(functor, std::move(args));
+}
+
+}  // namespace builders
+
 #endif // TERM_UNIFICATION_H
@@ -0,0 +1,451 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "term_memory.h"
+#include "term_store.h"
+#include "term_unification.h"
+
+/* Benchmark driver for the unifier.
+   Build alongside term_unification_lib.cpp with optimizations, e.g.
+       g++ -std=c++17 -O2 -pthread *_lib.cpp term_unification_bench.cpp -o bench
+   Times are wall-clock averages over repeated runs.
+   Usage: bench [scale=1000] [iterations=200]
+   Before timing, every shape and workload is checked to unify (or fail) as designed;
+   the bench exits with status 1 if one does not, so "bench 50 1" doubles as a test.
+   The first table compares node dispatch styles on the client's 11 shapes; the second
+   runs the scalable workloads and reports ns/op, ops/s, ns per input node and heap
+   allocations per operation (counted by the operator new replacements below).
+*/
+
+// ------------------------------ Allocations --------------------------------
+// Every global operator new bumps this counter; the bench is single-threaded.
+std::size_t allocations = 0;
+
+void* countedAlloc(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    ++allocations;
+    const auto alignment = static_cast<std::size_t>(align);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return countedAlignedAlloc(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return countedAlignedAlloc(size, align);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+namespace builders {
+
+// cons(e1, cons(e2, ... tail)) with elements produced by make(i).
+template <typename Make>
+TermPtr list(std::size_t length, Make make, TermPtr tail) {
+    for (std::size_t i = length; i > 0; --i) {
+        tail = compound("cons", make(i - 1), std::move(tail));
+    }
+    return tail;
+}
+
+// functor(make(0), ..., make(width - 1))
+template <typename Make>
+TermPtr wide(std::string functor, std::size_t width, Make make) {
+    std::vector<TermPtr> args;
+    args.reserve(width);
+    for (std::size_t i = 0; i < width; ++i) {
+        args.push_back(make(i));
+    }
+    return compound(std::move(functor), std::move(args));
+}
+
+}  // namespace builders
+
+struct Shape {
+    std::string name;
+    TermPtr t1;
+    TermPtr t2;
+    bool unifies;  // under the default (full) occurs check
+};
+
+// The 11 client test shapes with every structure scaled by n.
+std::vector<Shape> buildShapes(std::size_t n) {
+    using namespace builders;
+    auto num = [](std::size_t i) { return constant(std::to_string(i)); };
+    auto varAt = [](std::size_t i) { return var("V" + std::to_string(i)); };
+    auto sameVar = [](std::size_t) { return var("X"); };
+
+    std::vector<Shape> shapes;
+    shapes.push_back({"var-const", var("X"), list(n, num, constant("nil")), true});
+    shapes.push_back({"const-var", list(n, num, constant("nil")), var("X"), true});
+    shapes.push_back({"const mismatch",
+                      list(n, num, constant("a")), list(n, num, constant("b")), false});
+    shapes.push_back({"compound match", wide("f", n, varAt), wide("f", n, num), true});
+    shapes.push_back({"functor mismatch", wide("f", n, sameVar), wide("g", n, sameVar), false});
+    shapes.push_back({"arity mismatch", wide("f", n, sameVar), wide("f", n + 1, sameVar), false});
+    shapes.push_back({"occurs check", var("X"), list(n, num, var("X")), false});
+    shapes.push_back({"deep cons", list(n, varAt, var("T")), list(n, num, constant("nil")), true});
+    shapes.push_back({"var-compound", var("X"), wide("g", n, varAt), true});
+    shapes.push_back({"two vars", wide("p", n, varAt), wide("p", n, [](std::size_t i) {
+                          return var("W" + std::to_string(i));
+                      }), true});
+    shapes.push_back({"pair mismatch", wide("pair", n, num), wide("pair", n, [n](std::size_t i) {
+                          return constant(std::to_string(i + 1 == n ? n : i));
+                      }), false});
+    return shapes;
+}
+
+// -------------------------------- Workloads --------------------------------
+// One operation unifies goal with every candidate in turn; every workload below has
+// exactly one candidate that unifies.
+struct Workload {
+    std::string name;
+    TermPtr goal;
+    std::vector<TermPtr> candidates;
+};
+
+Workload single(std::string name, TermPtr goal, TermPtr candidate) {
+    Workload workload{std::move(name), std::move(goal), {}};
+    workload.candidates.push_back(std::move(candidate));
+    return workload;
+}
+
+std::vector<Workload> buildWorkloads(std::size_t n) {
+    using namespace builders;
+    auto num = [](std::size_t i) { return constant(std::to_string(i)); };
+    auto varAt = [](std::size_t i) { return var("V" + std::to_string(i)); };
+
+    std::vector<Workload> workloads;
+    workloads.push_back(
+        single("deep list", list(n, varAt, var("T")), list(n, num, constant("nil"))));
+    workloads.push_back(single("wide compound", wide("f", n, varAt), wide("f", n, num)));
+
+    // 16 and 17 variables reused across n positions: long var-var chains to resolve
+    workloads.push_back(single("shared vars",
+                               wide("p", n, [](std::size_t i) {
+                                   return var("S" + std::to_string(i % 16));
+                               }),
+                               wide("p", n, [](std::size_t i) {
+                                   return var("R" + std::to_string(i % 17));
+                               })));
+
+    // C(n-1) = s(C(n)), then C(n-2) = s(C(n-1)), ...: each occurs check walks the chain
+    // built so far, so the work is quadratic in n
+    workloads.push_back(single("occurs chain",
+                               wide("eq", n, [n](std::size_t i) {
+                                   return var("C" + std::to_string(n - 1 - i));
+                               }),
+                               wide("eq", n, [n](std::size_t i) {
+                                   return compound("s", var("C" + std::to_string(n - i)));
+                               })));
+
+    // n candidate records that all differ from the goal only in the last argument
+    Workload scan{"failing scan",
+                  compound("rec", var("K"), constant("x"), constant("y"), constant("key")),
+                  {}};
+    for (std::size_t i = 0; i < n; ++i) {
+        scan.candidates.push_back(compound("rec", num(i), constant("x"), constant("y"),
+                                           constant(i + 1 == n ? "key" : "other")));
+    }
+    workloads.push_back(std::move(scan));
+    return workloads;
+}
+
+// ----------------------------- Dispatch styles -----------------------------
+// Reference traversals in the old RTTI style, kept here only for comparison.
+namespace rtti {
+
+std::size_t countNodes(const Term<std::string>& term) {
+    if (dynamic_cast<const Variable*>(&term) != nullptr ||
+        dynamic_cast<const Constant*>(&term) != nullptr) {
+        return 1;
+    }
+    const auto* comp = dynamic_cast<const Compound<std::string>*>(&term);
+    std::size_t count = 1;
+    for (std::size_t i = 0; i < comp->arity(); ++i) {
+        count += countNodes(comp->arg(i));
+    }
+    return count;
+}
+
+void print(const Term<std::string>& term, std::ostream& out) {
+    if (const auto* v = dynamic_cast<const Variable*>(&term)) {
+        out << v->name();
+    } else if (const auto* c = dynamic_cast<const Constant*>(&term)) {
+        out << c->value();
+    } else if (const auto* comp = dynamic_cast<const Compound<std::string>*>(&term)) {
+        out << comp->functor() << "(";
+        for (std::size_t i = 0; i < comp->arity(); ++i) {
+            if (i > 0) {
+                out << ", ";
+            }
+            print(comp->arg(i), out);
+        }
+        out << ")";
+    }
+}
+
+}  // namespace rtti
+
+namespace tagged {
+
+std::size_t countNodes(const Term<std::string>& term) {
+    if (!term.isCompound()) {
+        return 1;
+    }
+    const auto& comp = termCast<Compound<std::string>>(term);
+    std::size_t count = 1;
+    for (std::size_t i = 0; i < comp.arity(); ++i) {
+        count += countNodes(comp.arg(i));
+    }
+    return count;
+}
+
+struct Printer {
+    std::ostream& out;
+
+    void operator()(const Variable& v) const { out << v.name(); }
+    void operator()(const Constant& c) const { out << c.value(); }
+    void operator()(const Compound<std::string>& comp) const {
+        out << comp.functor() << "(";
+        for (std::size_t i = 0; i < comp.arity(); ++i) {
+            if (i > 0) {
+                out << ", ";
+            }
+            visitTerm(comp.arg(i), *this);
+        }
+        out << ")";
+    }
+};
+
+void print(const Term<std::string>& term, std::ostream& out) {
+    visitTerm(term, Printer{out});
+}
+
+}  // namespace tagged
+
+// --------------------------------- Timing ----------------------------------
+
+// Runs fn repeatedly and returns the mean nanoseconds per call.
+template <typename Fn>
+double nanosPerCall(std::size_t iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(iterations);
+}
+
+// Runs fn repeatedly and returns the mean heap allocations per call.
+template <typename Fn>
+double allocationsPerCall(std::size_t iterations, Fn&& fn) {
+    const std::size_t before = allocations;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return static_cast<double>(allocations - before) / static_cast<double>(iterations);
+}
+
+// Keeps results observable so the optimizer cannot drop the measured work.
+volatile std::size_t sink = 0;
+
+// Checks that every shape and workload unifies as designed, so a broken generator
+// cannot quietly time the wrong work; reports each mismatch and returns false if any.
+bool verify(const std::vector<Shape>& shapes,
+            const std::vector<Workload>& workloads,
+            Unifier& unifier) {
+    bool ok = true;
+    for (const auto& shape : shapes) {
+        if (unifier.unify(*shape.t1, *shape.t2).has_value() != shape.unifies) {
+            std::cerr << "shape '" << shape.name << "' should "
+                      << (shape.unifies ? "" : "not ") << "unify\n";
+            ok = false;
+        }
+    }
+    for (const auto& workload : workloads) {
+        std::size_t successes = 0;
+        for (const auto& candidate : workload.candidates) {
+            successes += unifier.unify(*workload.goal, *candidate).has_value();
+        }
+        if (successes != 1) {
+            std::cerr << "workload '" << workload.name << "' has " << successes
+                      << " unifying candidates, not 1\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t scale = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const std::size_t iterations = argc > 2 ? std::stoul(argv[2]) : 200;
+    auto shapes = buildShapes(scale);
+    auto workloads = buildWorkloads(scale);
+    Unifier unifier;
+    if (!verify(shapes, workloads, unifier)) {
+        return 1;
+    }
+
+    std::cout << "scale " << scale << ", " << iterations << " iterations per cell (ns/op)\n";
+    std::cout << "shape              count:rtti  count:tag  print:rtti  print:tag      unify\n";
+    for (const auto& shape : shapes) {
+        const double countRtti = nanosPerCall(iterations, [&] {
+            sink = sink + rtti::countNodes(*shape.t1) + rtti::countNodes(*shape.t2);
+        });
+        const double countTag = nanosPerCall(iterations, [&] {
+            sink = sink + tagged::countNodes(*shape.t1) + tagged::countNodes(*shape.t2);
+        });
+        std::ostringstream out;
+        const double printRtti = nanosPerCall(iterations, [&] {
+            out.str({});
+            rtti::print(*shape.t1, out);
+            rtti::print(*shape.t2, out);
+        });
+        const double printTag = nanosPerCall(iterations, [&] {
+            out.str({});
+            tagged::print(*shape.t1, out);
+            tagged::print(*shape.t2, out);
+        });
+        const double unify = nanosPerCall(iterations, [&] {
+            sink = sink + unifier.unify(*shape.t1, *shape.t2).has_value();
+        });
+
+        std::string label = shape.name;
+        label.resize(18, ' ');
+        std::cout << label << ' ' << std::fixed;
+        std::cout.precision(0);
+        for (double value : {countRtti, countTag, printRtti, printTag, unify}) {
+            std::cout.width(11);
+            std::cout << value;
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "\nworkload             nodes      ns/op      ops/s    ns/node  allocs/op\n";
+    for (const auto& workload : workloads) {
+        std::size_t nodes = tagged::countNodes(*workload.goal) * workload.candidates.size();
+        for (const auto& candidate : workload.candidates) {
+            nodes += tagged::countNodes(*candidate);
+        }
+        auto op = [&] {
+            for (const auto& candidate : workload.candidates) {
+                sink = sink + unifier.unify(*workload.goal, *candidate).has_value();
+            }
+        };
+        op();  // warm the unifier's reusable buffers
+        const double nanos = nanosPerCall(iterations, op);
+        const double allocs = allocationsPerCall(iterations, op);
+
+        std::string label = workload.name;
+        label.resize(16, ' ');
+        std::cout << label << std::fixed;
+        std::cout.precision(0);
+        for (double value : {static_cast<double>(nodes), nanos, 1e9 / nanos}) {
+            std::cout.width(11);
+            std::cout << value;
+        }
+        std::cout.precision(2);
+        for (double value : {nanos / static_cast<double>(nodes), allocs}) {
+            std::cout.width(11);
+            std::cout << value;
+        }
+        std::cout << "\n";
+    }
+
+    // bytes per representation, symbol text left out on both sides: pointer terms share
+    // the process-wide registry and the store keeps its own table
+    std::cout << "\nmemory               nodes    pointer  B/node:ptr      store  B/node:st\n";
+    for (const auto& shape : shapes) {
+        MemoryFootprint pointer = footprint(*shape.t1);
+        pointer += footprint(*shape.t2);
+        TermStore store;
+        store.intern(*shape.t1);
+        store.intern(*shape.t2);
+        store.shrinkToFit();
+        const MemoryFootprint stored = store.memoryFootprint();
+        const auto storeBytes = static_cast<double>(stored.total() - stored.symbols);
+        const double nodes = static_cast<double>(
+            pointer.variables.count + pointer.constants.count + pointer.compounds.count);
+
+        std::string label = shape.name;
+        label.resize(16, ' ');
+        std::cout << label << std::fixed;
+        std::cout.precision(0);
+        for (double value : {nodes, static_cast<double>(pointer.total())}) {
+            std::cout.width(11);
+            std::cout << value;
+        }
+        std::cout.precision(2);
+        std::cout.width(11);
+        std::cout << static_cast<double>(pointer.total()) / nodes;
+        std::cout.precision(0);
+        std::cout.width(11);
+        std::cout << storeBytes;
+        std::cout.precision(2);
+        std::cout.width(11);
+        std::cout << storeBytes / nodes << "\n";
+    }
+    return 0;
+}
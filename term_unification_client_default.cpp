@@ -6,6 +6,7 @@
 #include <utility>
 #include <vector>
 
+#include "term_format.h"
 #include "term_unification.h"
 
 /* Sample output (after you implement Unifier):
@@ -24,58 +25,6 @@ Test 11 (pair mismatch): failure
 
 using TermPtr = std::unique_ptr<Term<std::string>>;
 
-namespace builders {
-
-TermPtr var(std::string name) {
-    return std::make_unique<Variable>(std::move(name));
-}
-
-TermPtr constant(std::string value) {
-    return std::make_unique<Constant>(std::move(value));
-}
-
-TermPtr compound(std::string functor, std::vector<TermPtr> args) {
-    return std::make_unique<Compound<std::string>>(std::move(functor), std::move(args));
-}
-
-}  // namespace builders
-
-void printTerm(const Term<std::string>& term, std::ostream& out) {
-    if (term.isVariable()) {
-        const auto* v = dynamic_cast<const Variable*>(&term);
-        out << v->name();
-    } else if (term.isConstant()) {
-        const auto* c = dynamic_cast<const Constant*>(&term);
-        out << c->value();
-    } else if (term.isCompound()) {
-        const auto* comp = dynamic_cast<const Compound<std::string>*>(&term);
-        out << comp->functor() << "(";
-        for (std::size_t i = 0; i < comp->arity(); ++i) {
-            if (i > 0) {
-                out << ", ";
-            }
-            printTerm(comp->arg(i), out);
-        }
-        out << ")";
-    }
-}
-
-void printTerm(const Term<std::string>& term) {
-    printTerm(term, std::cout);
-}
-
-void printSubstitution(const Unifier::Substitution& sub) {
-    bool first = true;
-    for (const auto& [varName, term] : sub) {
-        if (!first) {
-            std::cout << ", ";
-        }
-        std::cout << varName << " -> ";
-        printTerm(*term, std::cout);
-        first = false;
-    }
-}
-
 struct TestCase {
     std::string name;
     TermPtr t1;
@@ -91,94 +40,40 @@ std::vector<TestCase> buildTests() {
     tests.push_back({"const-var", constant("b"), var("X"), true});
     tests.push_back({"const mismatch", constant("a"), constant("b"), false});
 
-    {
-        std::vector<TermPtr> lhsArgs;
-        lhsArgs.push_back(var("X"));
-        lhsArgs.push_back(constant("b"));
-        std::vector<TermPtr> rhsArgs;
-        rhsArgs.push_back(constant("a"));
-        rhsArgs.push_back(constant("b"));
-        tests.push_back({"compound match",
-                         compound("f", std::move(lhsArgs)),
-                         compound("f", std::move(rhsArgs)),
-                         true});
-    }
+    tests.push_back({"compound match",
+                     compound("f", var("X"), constant("b")),
+                     compound("f", constant("a"), constant("b")),
+                     true});
 
-    {
-        std::vector<TermPtr> lhsArgs;
-        lhsArgs.push_back(var("X"));
-        std::vector<TermPtr> rhsArgs;
-        rhsArgs.push_back(var("X"));
-        tests.push_back({"functor mismatch",
-                         compound("f", std::move(lhsArgs)),
-                         compound("g", std::move(rhsArgs)),
-                         false});
-    }
+    tests.push_back({"functor mismatch",
+                     compound("f", var("X")),
+                     compound("g", var("X")),
+                     false});
 
-    {
-        std::vector<TermPtr> lhsArgs;
-        lhsArgs.push_back(var("X"));
-        std::vector<TermPtr> rhsArgs;
-        rhsArgs.push_back(var("X"));
-        rhsArgs.push_back(var("Y"));
-        tests.push_back({"arity mismatch",
-                         compound("f", std::move(lhsArgs)),
-                         compound("f", std::move(rhsArgs)),
-                         false});
-    }
+    tests.push_back({"arity mismatch",
+                     compound("f", var("X")),
+                     compound("f", var("X"), var("Y")),
+                     false});
 
-    {
-        std::vector<TermPtr> rhsArgs;
-        rhsArgs.push_back(var("X"));
-        tests.push_back({"occurs check",
-                         var("X"),
-                         compound("f", std::move(rhsArgs)),
-                         false});
-    }
+    tests.push_back({"occurs check", var("X"), compound("f", var("X")), false});
 
-    {
-        // cons(H, T) vs cons(1, cons(2, nil))
-        std::vector<TermPtr> lhsArgs;
-        lhsArgs.push_back(var("H"));
-        lhsArgs.push_back(var("T"));
-
-        std::vector<TermPtr> innerArgs;
-        innerArgs.push_back(constant("2"));
-        innerArgs.push_back(constant("nil"));
-        std::vector<TermPtr> rhsArgs;
-        rhsArgs.push_back(constant("1"));
-        rhsArgs.push_back(compound("cons", std::move(innerArgs)));
-        tests.push_back({"deep cons",
-                         compound("cons", std::move(lhsArgs)),
-                         compound("cons", std::move(rhsArgs)),
-                         true});
-    }
+    // cons(H, T) vs cons(1, cons(2, nil))
+    tests.push_back({"deep cons",
+                     compound("cons", var("H"), var("T")),
+                     compound("cons",
+                              constant("1"),
+                              compound("cons", constant("2"), constant("nil"))),
+                     true});
 
-    {
-        // X vs g(a, Y)
-        std::vector<TermPtr> rhsArgs;
-        rhsArgs.push_back(constant("a"));
-        rhsArgs.push_back(var("Y"));
-        tests.push_back(
-            {"var-compound", var("X"), compound("g", std::move(rhsArgs)), true});
-    }
+    // X vs g(a, Y)
+    tests.push_back({"var-compound", var("X"), compound("g", constant("a"), var("Y")), true});
 
-    {
-        tests.push_back({"two vars", var("X"), var("Y"), true});
-    }
+    tests.push_back({"two vars", var("X"), var("Y"), true});
 
-    {
-        std::vector<TermPtr> lhsArgs;
-        lhsArgs.push_back(constant("a"));
-        lhsArgs.push_back(constant("b"));
-        std::vector<TermPtr> rhsArgs;
-        rhsArgs.push_back(constant("a"));
-        rhsArgs.push_back(constant("c"));
-        tests.push_back({"pair mismatch",
-                         compound("pair", std::move(lhsArgs)),
-                         compound("pair", std::move(rhsArgs)),
-                         false});
-    }
+    tests.push_back({"pair mismatch",
+                     compound("pair", constant("a"), constant("b")),
+                     compound("pair", constant("a"), constant("c")),
+                     false});
 
     return tests;
 }
@@ -200,8 +95,9 @@ std::vector<TestCase> buildTests() {
 
 /*
     Design Notes: 
-    - The unifier always applies the current replacements to both elements before trying to match them
-    - Every term used in a substitution is deep copy to stop any accidental changes and shared references. 
+    - The unifier resolves the current bindings of both elements before trying to match them
+    - Bindings are references into the input terms while unifying; the returned substitution deep copies each one once, with every binding applied. 
+    - unifyShared() skips that copy and hands back the references themselves; toOwned() copies them later if needed.
     - The occurrences check looks at variables and compound phrases to prevent creating cycles like X = f(X). 
     - Two terms will only join if they:
          - have the same name, 
@@ -211,6 +107,8 @@ std::vector<TestCase> buildTests() {
 
 int main() {
     Unifier unifier;
+    TermFormatter formatter;
+    std::string line;
     auto tests = buildTests();
 
     int passed = 0;
@@ -218,17 +116,18 @@ int main() {
         const auto& test = tests[i];
         auto result = unifier.unify(*test.t1, *test.t2);
         bool success = result.has_value();
-        std::cout << "Test " << (i + 1) << " (" << test.name << "): ";
-        printTerm(*test.t1);
-        std::cout << "  ~  ";
-        printTerm(*test.t2);
-        std::cout << " => " << (success ? "success" : "failure");
+        line = "Test " + std::to_string(i + 1) + " (" + test.name + "): ";
+        formatter.append(line, *test.t1);
+        line += "  ~  ";
+        formatter.append(line, *test.t2);
+        line += success ? " => success" : " => failure";
         if (success && result) {
-            std::cout << " {";
-            printSubstitution(*result);
-            std::cout << "}";
+            line += " {";
+            formatter.append(line, *result);
+            line += "}";
         }
-        std::cout << "\n";
+        line += '\n';
+        std::cout << line;
         passed += (success == test.expectSuccess) ? 1 : 0;
     }
 
@@ -2,22 +2,226 @@
 
 #include <stdexcept>
 
-// TODO: Implement full unification logic with occurs check.
+#include "term_arena.h"
+
+// Counting for UnifierStats; compiled out unless TERM_UNIFICATION_STATS is defined.
+#ifdef TERM_UNIFICATION_STATS
+#define UNIFIER_COUNT(field) (++stats_.field)
+#else
+#define UNIFIER_COUNT(field) ((void)0)
+#endif
+
+namespace {
+
+// Steps a deferred-check unification takes before its first cycle check (see
+// unifyInternal); the interval doubles after each check.
+constexpr std::size_t kFirstCycleCheck = 256;
+
+}  // namespace
+
+// -------------------------------- Dispatch --------------------------------
+
+bool identical(const Term<std::string>& a, const Term<std::string>& b, TermPairStack& pending) {
+    pending.clear();
+    pending.emplace_back(&a, &b);
+    while (!pending.empty()) {
+        const auto [lhs, rhs] = pending.back();
+        pending.pop_back();
+        if (lhs == rhs) {
+            continue;
+        }
+        if (lhs->kind() != rhs->kind()) {
+            return false;
+        }
+        switch (lhs->kind()) {
+        case TermKind::Variable:
+            if (termCast<Variable>(*lhs).id() != termCast<Variable>(*rhs).id()) {
+                return false;
+            }
+            break;
+        case TermKind::Constant:
+            if (termCast<Constant>(*lhs).id() != termCast<Constant>(*rhs).id()) {
+                return false;
+            }
+            break;
+        case TermKind::Compound: {
+            const auto& lc = termCast<Compound<std::string>>(*lhs);
+            const auto& rc = termCast<Compound<std::string>>(*rhs);
+            if (lc.functorId() != rc.functorId() || lc.arity() != rc.arity()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < lc.arity(); ++i) {
+                pending.emplace_back(&lc.arg(i), &rc.arg(i));
+            }
+            break;
+        }
+        }
+    }
+    return true;
+}
+
+// -------------------------------- Bindings --------------------------------
+
+void Bindings::grow() {
+    std::pmr::vector<Slot> old(std::move(slots_), slots_.get_allocator());
+    slots_.assign(old.empty() ? 16 : old.size() * 2, Slot{kEmpty, nullptr, nullptr});
+    const std::size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == kEmpty) {
+            continue;
+        }
+        std::size_t i = home(slot.id);
+        while (slots_[i].id != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = slot;
+    }
+}
+
+void Bindings::erase(SymbolId id) noexcept {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t hole = home(id);
+    while (slots_[hole].id != id) {
+        hole = (hole + 1) & mask;
+    }
+    // backward-shift deletion, as in RenamedBindings
+    for (std::size_t next = (hole + 1) & mask; slots_[next].id != kEmpty;
+         next = (next + 1) & mask) {
+        const std::size_t want = home(slots_[next].id);
+        const bool movable = hole <= next ? (want <= hole || want > next)
+                                          : (want <= hole && want > next);
+        if (movable) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole].id = kEmpty;
+}
+
+// --------------------------------- Unifier ---------------------------------
+
+Unifier::Unifier(TermArena& arena) noexcept : scratch_(&arena) {}
 
 std::optional<Unifier::Substitution> Unifier::unify(const Term<std::string>& t1,
                                                     const Term<std::string>& t2) {
-    // create a working sub map
-    Substitution working;
+    // start from an empty working set of lazy bindings
+    Bindings& working = scratch_;
+    working.clear();
     // attempt to unify internally and check for failure
-    if (!unifyInternal(t1, t2, working)) {
+    if (!unifyInternal(t1, t2, working) ||
+        (occursCheck_ == OccursCheck::Deferred && !acyclic(working))) {
         // return no value on failure
         return std::nullopt;
     }
-    // return successful sub
-    return working;
+    // copy each binding out once, fully applied; triangular chains stay internal
+    return resolveOut(working);
+}
+
+std::optional<Unifier::SharedSubstitution> Unifier::unifyShared(const Term<std::string>& t1,
+                                                                const Term<std::string>& t2) {
+    Bindings& working = scratch_;
+    working.clear();
+    if (!unifyInternal(t1, t2, working) ||
+        (occursCheck_ == OccursCheck::Deferred && !acyclic(working))) {
+        return std::nullopt;
+    }
+    return shareOut(working);
+}
+
+bool Unifier::unify(const Term<std::string>& t1,
+                    const Term<std::string>& t2,
+                    Bindings& bindings) {
+    const Bindings::Mark entry = bindings.mark();
+    if (!unifyInternal(t1, t2, bindings) ||
+        (occursCheck_ == OccursCheck::Deferred && !acyclic(bindings))) {
+        bindings.undoTo(entry);
+        return false;
+    }
+    return true;
+}
+
+std::optional<Unifier::Substitution> Unifier::unifyAll(const std::vector<TermPair>& pairs) {
+    Substitution result;
+    if (!extend(pairs.data(), pairs.size(), result)) {
+        return std::nullopt;
+    }
+    return result;
 }
 
-// TODO: Apply substitutions recursively to produce a fully bound deep copy.
+bool Unifier::unifyInto(const Term<std::string>& t1,
+                        const Term<std::string>& t2,
+                        Substitution& sub) {
+    const TermPair pair(&t1, &t2);
+    return extend(&pair, 1, sub);
+}
+
+bool Unifier::unifyInto(const std::vector<TermPair>& pairs, Substitution& sub) {
+    return extend(pairs.data(), pairs.size(), sub);
+}
+
+bool Unifier::extend(const TermPair* pairs, std::size_t count, Substitution& sub) {
+    // load the existing entries as bindings; their values are read, never rewritten
+    Bindings& working = scratch_;
+    working.clear();
+    seedVariables_.clear();
+    seedVariables_.reserve(sub.size());
+    for (const auto& [name, value] : sub) {
+        seedVariables_.emplace_back(name);
+        working.bind(seedVariables_.back(), *value);
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!unifyInternal(*pairs[i].first, *pairs[i].second, working)) {
+            return false;
+        }
+    }
+    if (occursCheck_ == OccursCheck::Deferred && !acyclic(working)) {
+        return false;
+    }
+
+    // bindings come back in the order they were made, so the seeded ones come first
+    auto it = working.begin();
+    for (std::size_t i = 0; i < seedVariables_.size(); ++i) {
+        ++it;
+    }
+    for (; it != working.end(); ++it) {
+        const auto [var, value] = *it;
+        sub.emplace(var->name(), cloneWithBindings(*value, working));
+    }
+    return true;
+}
+
+std::optional<Unifier::Substitution> Unifier::match(const Term<std::string>& pattern,
+                                                    const Term<std::string>& subject) {
+    Bindings& working = scratch_;
+    working.clear();
+    if (!matchInternal(pattern, subject, working)) {
+        return std::nullopt;
+    }
+    // values are subject subterms taken as they are
+    return copyOut(working);
+}
+
+std::optional<Unifier::SharedSubstitution> Unifier::matchShared(
+    const Term<std::string>& pattern, const Term<std::string>& subject) {
+    Bindings& working = scratch_;
+    working.clear();
+    if (!matchInternal(pattern, subject, working)) {
+        return std::nullopt;
+    }
+    return shareOut(working);
+}
+
+bool Unifier::match(const Term<std::string>& pattern,
+                    const Term<std::string>& subject,
+                    Bindings& bindings) {
+    const Bindings::Mark entry = bindings.mark();
+    if (!matchInternal(pattern, subject, bindings)) {
+        bindings.undoTo(entry);
+        return false;
+    }
+    return true;
+}
 
 std::unique_ptr<Term<std::string>> Unifier::substitute(const Term<std::string>& term,
                                                        const Substitution& sub) const {
@@ -25,128 +229,349 @@ std::unique_ptr<Term<std::string>> Unifier::substitute(const Term<std::string>&
     return cloneWithSubstitution(term, sub);
 }
 
-// TODO: Implement occurs check to prevent circular bindings.
+std::unique_ptr<Term<std::string>> Unifier::substitute(const Term<std::string>& term,
+                                                       const Bindings& bindings) const {
+    return cloneWithBindings(term, bindings);
+}
 
-bool Unifier::occurs(const std::string& varName,
-                     const Term<std::string>& term,
-                     const Substitution& sub) const {
-    if (term.isVariable()) {
-        const auto* v = dynamic_cast<const Variable*>(&term);
-        if (v->name() == varName) {
-            return true;
-        }
-        auto it = sub.find(v->name());
-        if (it != sub.end()) {
-            return occurs(varName, *it->second, sub);
+std::unique_ptr<Term<std::string>> Unifier::substitute(const Term<std::string>& term,
+                                                       const SharedSubstitution& sub) const {
+    return cloneResolved(term, [&sub](const Term<std::string>& t) -> const Term<std::string>& {
+        const Term<std::string>* current = &t;
+        while (current->isVariable()) {
+            auto it = sub.find(termCast<Variable>(*current).name());
+            if (it == sub.end()) {
+                break;
+            }
+            current = it->second;
         }
-        return false;
+        return *current;
+    });
+}
+
+Unifier::Substitution Unifier::toOwned(const SharedSubstitution& shared) const {
+    Substitution result;
+    for (const auto& [name, value] : shared) {
+        result.emplace(std::string(name), substitute(*value, shared));
     }
+    return result;
+}
 
-    if (term.isConstant()) {
+Unifier::Substitution Unifier::resolveOut(const Bindings& bindings) const {
+    Substitution result;
+    for (const auto& [var, value] : bindings) {
+        result.emplace(var->name(), cloneWithBindings(*value, bindings));
+    }
+    return result;
+}
+
+Unifier::Substitution Unifier::copyOut(const Bindings& bindings) const {
+    Substitution result;
+    for (const auto& [var, value] : bindings) {
+        result.emplace(var->name(),
+                       cloneResolved(*value, [](const Term<std::string>& t) -> const auto& {
+                           return t;
+                       }));
+    }
+    return result;
+}
+
+Unifier::SharedSubstitution Unifier::shareOut(const Bindings& bindings) {
+    SharedSubstitution result;
+    for (const auto& [var, value] : bindings) {
+        result.emplace(var->name(), value);
+    }
+    return result;
+}
+
+bool Unifier::occurs(SymbolId varId,
+                     const Term<std::string>& term,
+                     Bindings& bindings) const {
+    if (occursCheck_ != OccursCheck::Full) {
         return false;
     }
+    scan_.clear();
+    scan_.push_back(&term);
+    while (!scan_.empty()) {
+        const Term<std::string>& resolved = bindings.resolve(*scan_.back());
+        scan_.pop_back();
+        UNIFIER_COUNT(occursVisits);
 
-    const auto* comp = dynamic_cast<const Compound<std::string>*>(&term);
-    for (std::size_t i = 0; i < comp->arity(); ++i) {
-        if (occurs(varName, comp->arg(i), sub)) {
-            return true;
+        if (resolved.isVariable()) {
+            if (termCast<Variable>(resolved).id() == varId) {
+                return true;
+            }
+            continue;
+        }
+
+        if (resolved.isConstant()) {
+            continue;
+        }
+
+        const auto& comp = termCast<Compound<std::string>>(resolved);
+        for (std::size_t i = 0; i < comp.arity(); ++i) {
+            scan_.push_back(&comp.arg(i));
         }
     }
     return false;
 }
 
-// TODO: Clone a term while applying the provided substitution map.
+bool Unifier::matchInternal(const Term<std::string>& pattern,
+                            const Term<std::string>& subject,
+                            Bindings& working) {
+    pairs_.clear();
+    pairs_.emplace_back(&pattern, &subject);
+    while (!pairs_.empty()) {
+        const auto [p, t] = pairs_.back();
+        pairs_.pop_back();
+        UNIFIER_COUNT(steps);
 
-std::unique_ptr<Term<std::string>> Unifier::cloneWithSubstitution(
-    const Term<std::string>& term, const Substitution& sub) const {
-    if (term.isVariable()) {
-        const auto* v = dynamic_cast<const Variable*>(&term);
-        auto it = sub.find(v->name());
-        if (it != sub.end()) {
-            return cloneWithSubstitution(*it->second, sub);
+        switch (p->kind()) {
+        case TermKind::Variable: {
+            // a repeated pattern variable must meet an identical subject subterm
+            const auto& var = termCast<Variable>(*p);
+            if (const Term<std::string>* bound = working.lookup(var)) {
+                if (!identical(*bound, *t, equalPairs_)) {
+                    UNIFIER_COUNT(repeatMismatches);
+                    return false;
+                }
+            } else {
+                working.bind(var, *t);
+                UNIFIER_COUNT(bindings);
+            }
+            break;
+        }
+        case TermKind::Constant:
+            if (!t->isConstant()) {
+                UNIFIER_COUNT(kindMismatches);
+                return false;
+            }
+            if (termCast<Constant>(*p).id() != termCast<Constant>(*t).id()) {
+                UNIFIER_COUNT(constantMismatches);
+                return false;
+            }
+            break;
+        case TermKind::Compound: {
+            if (!t->isCompound()) {
+                UNIFIER_COUNT(kindMismatches);
+                return false;
+            }
+            const auto& pc = termCast<Compound<std::string>>(*p);
+            const auto& tc = termCast<Compound<std::string>>(*t);
+            if (pc.functorId() != tc.functorId()) {
+                UNIFIER_COUNT(functorMismatches);
+                return false;
+            }
+            if (pc.arity() != tc.arity()) {
+                UNIFIER_COUNT(arityMismatches);
+                return false;
+            }
+            for (std::size_t i = pc.arity(); i > 0; --i) {
+                pairs_.emplace_back(&pc.arg(i - 1), &tc.arg(i - 1));
+            }
+            break;
+        }
         }
-        return std::make_unique<Variable>(v->name());
     }
+    return true;
+}
 
-    if (term.isConstant()) {
-        const auto* c = dynamic_cast<const Constant*>(&term);
-        return std::make_unique<Constant>(c->value());
-    }
+bool Unifier::acyclic(const Bindings& bindings) {
+    // depth-first over bound variables; a nullptr entry marks leaving its variable
+    cycleDone_.clear();
+    for (const auto& [var, value] : bindings) {
+        if (cycleDone_.count(var->id()) != 0) {
+            continue;
+        }
+        cycleDone_[var->id()] = false;
+        cycleScan_.clear();
+        cycleScan_.emplace_back(nullptr, var->id());
+        cycleScan_.emplace_back(value, 0);
+        while (!cycleScan_.empty()) {
+            const auto [term, exitId] = cycleScan_.back();
+            cycleScan_.pop_back();
+            UNIFIER_COUNT(occursVisits);
+            if (term == nullptr) {
+                cycleDone_[exitId] = true;
+                continue;
+            }
+
+            if (term->isCompound()) {
+                const auto& comp = termCast<Compound<std::string>>(*term);
+                for (std::size_t i = 0; i < comp.arity(); ++i) {
+                    cycleScan_.emplace_back(&comp.arg(i), 0);
+                }
+                continue;
+            }
 
-    const auto* comp = dynamic_cast<const Compound<std::string>*>(&term);
-    std::vector<std::unique_ptr<Term<std::string>>> clonedArgs;
-    clonedArgs.reserve(comp->arity());
-    for (std::size_t i = 0; i < comp->arity(); ++i) {
-        clonedArgs.push_back(cloneWithSubstitution(comp->arg(i), sub));
+            if (!term->isVariable()) {
+                continue;
+            }
+            const auto& inner = termCast<Variable>(*term);
+            const Term<std::string>* bound = bindings.lookup(inner);
+            if (bound == nullptr) {
+                continue;
+            }
+            auto [it, fresh] = cycleDone_.try_emplace(inner.id(), false);
+            if (!fresh) {
+                if (!it->second) {
+                    // reached a variable that is still being expanded
+                    UNIFIER_COUNT(occursFailures);
+                    return false;
+                }
+                continue;
+            }
+            cycleScan_.emplace_back(nullptr, it->first);
+            cycleScan_.emplace_back(bound, 0);
+        }
     }
-    return std::make_unique<Compound<std::string>>(comp->functor(), std::move(clonedArgs));
+    return true;
 }
 
-// TODO: Recursive unification helper. Mutates working substitution on success.
+std::unique_ptr<Term<std::string>> Unifier::cloneWithSubstitution(
+    const Term<std::string>& term, const Substitution& sub) const {
+    return cloneResolved(term, [&sub](const Term<std::string>& t) -> const Term<std::string>& {
+        const Term<std::string>* current = &t;
+        while (current->isVariable()) {
+            auto it = sub.find(termCast<Variable>(*current).name());
+            if (it == sub.end()) {
+                break;
+            }
+            current = it->second.get();
+        }
+        return *current;
+    });
+}
+
+std::unique_ptr<Term<std::string>> Unifier::cloneWithBindings(
+    const Term<std::string>& term, const Bindings& bindings) const {
+    return cloneResolved(term, [&bindings](const Term<std::string>& t) -> const auto& {
+        return bindings.resolve(t);
+    });
+}
+
+template <typename Resolve>
+std::unique_ptr<Term<std::string>> Unifier::cloneResolved(const Term<std::string>& term,
+                                                          Resolve resolve) const {
+    return cloner_.build(&term, [&](const Term<std::string>* node, auto& step) {
+        const Term<std::string>& resolved = resolve(*node);
+        UNIFIER_COUNT(clonedNodes);
+        switch (resolved.kind()) {
+        case TermKind::Variable:
+            step.leaf(std::make_unique<Variable>(termCast<Variable>(resolved)));
+            break;
+        case TermKind::Constant:
+            step.leaf(std::make_unique<Constant>(termCast<Constant>(resolved)));
+            break;
+        case TermKind::Compound: {
+            const auto& comp = termCast<Compound<std::string>>(resolved);
+            step.compound(comp);
+            for (std::size_t i = 0; i < comp.arity(); ++i) {
+                step.child(&comp.arg(i));
+            }
+            break;
+        }
+        }
+    });
+}
 
 bool Unifier::unifyInternal(const Term<std::string>& a,
                             const Term<std::string>& b,
-                            Substitution& working) {
-    //current substitutions to both terms to work with their reduced forms.
-    auto aReduced = cloneWithSubstitution(a, working);
-    auto bReduced = cloneWithSubstitution(b, working);
-
-    const Term<std::string>& lhs = *aReduced;
-    const Term<std::string>& rhs = *bReduced;
-
-    // the variable cases
-    if (lhs.isVariable() && rhs.isVariable()) {
-        const auto* lv = dynamic_cast<const Variable*>(&lhs);
-        const auto* rv = dynamic_cast<const Variable*>(&rhs);
-        if (lv->name() == rv->name()) {
-            return true;
-        }
-        // bind lexicographically smaller variable to other
-        const auto* first = (lv->name() < rv->name()) ? lv : rv;
-        const auto* second = (first == lv) ? rv : lv;
-        working[first->name()] = std::make_unique<Variable>(second->name());
-        return true;
-    }
-
-    if (lhs.isVariable()) {
-        const auto* lv = dynamic_cast<const Variable*>(&lhs);
-        if (occurs(lv->name(), rhs, working)) {
-            return false;
+                            Bindings& working) {
+    // with the check deferred, a cycle already bound (X = f(X)) can keep the stack
+    // growing without end, e.g. for g(X, X) = g(f(X), f(X)); checking the bindings each
+    // time the step count doubles fails those calls at a logarithmic number of checks
+    std::size_t steps = 0;
+    std::size_t nextCycleCheck = kFirstCycleCheck;
+    pairs_.clear();
+    pairs_.emplace_back(&a, &b);
+    while (!pairs_.empty()) {
+        // follow current bindings on both terms to work with their reduced forms
+        const Term<std::string>& lhs = working.resolve(*pairs_.back().first);
+        const Term<std::string>& rhs = working.resolve(*pairs_.back().second);
+        pairs_.pop_back();
+        UNIFIER_COUNT(steps);
+
+        // the same node is the same term under any bindings
+        if (&lhs == &rhs) {
+            continue;
+        }
+        if (occursCheck_ == OccursCheck::Deferred && ++steps == nextCycleCheck) {
+            if (!acyclic(working)) {
+                return false;
+            }
+            nextCycleCheck *= 2;
         }
-        working[lv->name()] = cloneWithSubstitution(rhs, working);
-        return true;
-    }
 
-    if (rhs.isVariable()) {
-        const auto* rv = dynamic_cast<const Variable*>(&rhs);
-        if (occurs(rv->name(), lhs, working)) {
-            return false;
+        // the variable cases
+        if (lhs.isVariable() && rhs.isVariable()) {
+            const auto* lv = &termCast<Variable>(lhs);
+            const auto* rv = &termCast<Variable>(rhs);
+            if (lv->id() == rv->id()) {
+                continue;
+            }
+            // bind lexicographically smaller variable to other; names, unlike the
+            // process-wide IDs, give the same answer whatever was interned before
+            const auto* first = (lv->name() < rv->name()) ? lv : rv;
+            const auto* second = (first == lv) ? rv : lv;
+            working.bind(*first, *second);
+            UNIFIER_COUNT(bindings);
+            continue;
         }
-        working[rv->name()] = cloneWithSubstitution(lhs, working);
-        return true;
-    }
 
-    // the const case
-    if (lhs.isConstant() && rhs.isConstant()) {
-        const auto* lc = dynamic_cast<const Constant*>(&lhs);
-        const auto* rc = dynamic_cast<const Constant*>(&rhs);
-        return lc->value() == rc->value();
-    }
+        if (lhs.isVariable()) {
+            const auto* lv = &termCast<Variable>(lhs);
+            if (occurs(lv->id(), rhs, working)) {
+                UNIFIER_COUNT(occursFailures);
+                return false;
+            }
+            working.bind(*lv, rhs);
+            UNIFIER_COUNT(bindings);
+            continue;
+        }
 
-    // compound case
-    if (lhs.isCompound() && rhs.isCompound()) {
-        const auto* lc = dynamic_cast<const Compound<std::string>*>(&lhs);
-        const auto* rc = dynamic_cast<const Compound<std::string>*>(&rhs);
-        if (lc->functor() != rc->functor() || lc->arity() != rc->arity()) {
-            return false;
+        if (rhs.isVariable()) {
+            const auto* rv = &termCast<Variable>(rhs);
+            if (occurs(rv->id(), lhs, working)) {
+                UNIFIER_COUNT(occursFailures);
+                return false;
+            }
+            working.bind(*rv, lhs);
+            UNIFIER_COUNT(bindings);
+            continue;
         }
-        for (std::size_t i = 0; i < lc->arity(); ++i) {
-            if (!unifyInternal(lc->arg(i), rc->arg(i), working)) {
+
+        // the const case
+        if (lhs.isConstant() && rhs.isConstant()) {
+            const auto* lc = &termCast<Constant>(lhs);
+            const auto* rc = &termCast<Constant>(rhs);
+            if (lc->id() != rc->id()) {
+                UNIFIER_COUNT(constantMismatches);
                 return false;
             }
+            continue;
         }
-        return true;
-    }
 
-    return false;
+        // compound case: queue argument pairs so the leftmost is handled first
+        if (lhs.isCompound() && rhs.isCompound()) {
+            const auto* lc = &termCast<Compound<std::string>>(lhs);
+            const auto* rc = &termCast<Compound<std::string>>(rhs);
+            if (lc->functorId() != rc->functorId()) {
+                UNIFIER_COUNT(functorMismatches);
+                return false;
+            }
+            if (lc->arity() != rc->arity()) {
+                UNIFIER_COUNT(arityMismatches);
+                return false;
+            }
+            for (std::size_t i = lc->arity(); i > 0; --i) {
+                pairs_.emplace_back(&lc->arg(i - 1), &rc->arg(i - 1));
+            }
+            continue;
+        }
+
+        UNIFIER_COUNT(kindMismatches);
+        return false;
+    }
+    return true;
 }
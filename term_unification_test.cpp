@@ -0,0 +1,395 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "term_format.h"
+#include "term_parser.h"
+#include "term_test.h"
+#include "term_unification.h"
+
+using TermPtr = std::unique_ptr<Term<std::string>>;
+
+// Formatted unify(lhs, rhs), or "failure".
+std::string unified(Unifier& unifier, const std::string& lhs, const std::string& rhs) {
+    TermPtr t1 = parseTerm(lhs);
+    TermPtr t2 = parseTerm(rhs);
+    auto result = unifier.unify(*t1, *t2);
+    return result ? formatSubstitution(*result) : "failure";
+}
+
+// Results are fully applied even though bindings are triangular while unifying.
+void testResolvedResults() {
+    Unifier unifier;
+    CHECK_EQ(unified(unifier, "f(X, Y)", "f(g(Y), a)"), "X -> g(a), Y -> a");
+    CHECK_EQ(unified(unifier, "f(X, Y, Z)", "f(Y, Z, h(W))"), "X -> h(W), Y -> h(W), Z -> h(W)");
+    CHECK_EQ(unified(unifier, "X", "Y"), "X -> Y");
+
+    TermPtr t1 = parseTerm("p(X, g(Y))");
+    TermPtr t2 = parseTerm("p(g(Y), g(b))");
+    auto shared = unifier.unifyShared(*t1, *t2);
+    CHECK(shared.has_value());
+    if (shared) {
+        CHECK_EQ(formatSubstitution(unifier.toOwned(*shared)), "X -> g(b), Y -> b");
+    }
+
+    TermPtr x = parseTerm("X");
+    TermPtr gy = parseTerm("g(Y)");
+    TermPtr y = parseTerm("Y");
+    TermPtr a = parseTerm("a");
+    auto all = unifier.unifyAll({{x.get(), gy.get()}, {y.get(), a.get()}});
+    CHECK(all.has_value());
+    if (all) {
+        CHECK_EQ(formatSubstitution(*all), "X -> g(a), Y -> a");
+    }
+}
+
+// Deferred rejects the same cycles as Full, including ones the pair loop would otherwise
+// keep expanding.
+void testDeferredOccursCheck() {
+    const char* cyclic[][2] = {
+        {"X", "f(X)"},
+        {"g(X, X)", "g(f(X), f(X))"},
+        {"g(X, Y, X, Y)", "g(f(X), f(Y), Y, X)"},
+        {"h(X, Y, X)", "h(f(Y), f(X), Y)"},
+    };
+    for (OccursCheck policy : {OccursCheck::Full, OccursCheck::Deferred}) {
+        Unifier unifier;
+        unifier.setOccursCheck(policy);
+        for (const auto& pair : cyclic) {
+            CHECK_EQ(unified(unifier, pair[0], pair[1]), "failure");
+        }
+        CHECK_EQ(unified(unifier, "g(X, Y)", "g(f(Y), a)"), "X -> f(a), Y -> a");
+        CHECK_EQ(unified(unifier, "g(X, X)", "g(f(Y), f(a))"), "X -> f(a), Y -> a");
+    }
+}
+
+// Dispatch goes by the kind tag each node stores.
+void testDispatch() {
+    TermPtr x = parseTerm("X");
+    TermPtr a = parseTerm("a");
+    TermPtr f = parseTerm("f(X, a)");
+    CHECK(x->kind() == TermKind::Variable && x->isVariable() && !x->isCompound());
+    CHECK(a->kind() == TermKind::Constant && a->isConstant() && !a->isVariable());
+    CHECK(f->kind() == TermKind::Compound && f->isCompound() && !f->isConstant());
+
+    CHECK(std::get<const Variable*>(asVariant(*x)) == &termCast<Variable>(*x));
+    CHECK(std::get<const Constant*>(asVariant(*a))->value() == "a");
+    CHECK_EQ(std::get<const Compound<std::string>*>(asVariant(*f))->arity(), 2u);
+
+    struct Describe {
+        std::string operator()(const Variable& v) const { return "var " + v.name(); }
+        std::string operator()(const Constant& c) const { return "const " + c.value(); }
+        std::string operator()(const Compound<std::string>& c) const {
+            return "compound " + c.functor() + "/" + std::to_string(c.arity());
+        }
+    };
+    CHECK_EQ(visitTerm(*x, Describe{}), "var X");
+    CHECK_EQ(visitTerm(*a, Describe{}), "const a");
+    CHECK_EQ(visitTerm(*f, Describe{}), "compound f/2");
+    CHECK_EQ(visitTerm(termCast<Compound<std::string>>(*f).arg(1), Describe{}), "const a");
+}
+
+// Every bind and path compression is trailed, so undoTo restores any earlier state, and a
+// failed unify(t1, t2, bindings) leaves bindings as they were.
+void testTrail() {
+    TermPtr chain = parseTerm("f(X, Y, Z)");
+    TermPtr links = parseTerm("f(Y, Z, a)");
+    const auto& comp = termCast<Compound<std::string>>(*chain);
+    const Term<std::string>& x = comp.arg(0);
+    const Term<std::string>& y = comp.arg(1);
+
+    Unifier unifier;
+    Bindings bindings;
+    const Bindings::Mark empty = bindings.mark();
+    CHECK(unifier.unify(*chain, *links, bindings));
+    CHECK_EQ(bindings.size(), 3u);
+    const Bindings::Mark bound = bindings.mark();
+    const Term<std::string>* direct = bindings.lookup(termCast<Variable>(x));
+    CHECK(direct != nullptr && direct->isVariable());
+
+    // resolving compresses X's chain, which is trailed too
+    CHECK_EQ(formatTerm(bindings.resolve(x)), "a");
+    CHECK(bindings.lookup(termCast<Variable>(x)) != direct);
+    CHECK(bindings.mark() > bound);
+    bindings.undoTo(bound);
+    CHECK(bindings.lookup(termCast<Variable>(x)) == direct);
+    CHECK_EQ(formatTerm(*unifier.substitute(*chain, bindings)), "f(a, a, a)");
+
+    TermPtr clash = parseTerm("f(b, W, W)");
+    CHECK(!unifier.unify(*chain, *clash, bindings));
+    CHECK(bindings.mark() == bound);
+    CHECK_EQ(bindings.size(), 3u);
+    TermPtr fits = parseTerm("f(W, a, V)");
+    CHECK(unifier.unify(*chain, *fits, bindings));
+    CHECK_EQ(bindings.size(), 5u);
+
+    bindings.undoTo(empty);
+    CHECK(bindings.empty());
+    CHECK(bindings.lookup(termCast<Variable>(y)) == nullptr);
+    CHECK_EQ(formatTerm(*unifier.substitute(*chain, bindings)), "f(X, Y, Z)");
+}
+
+// s(s(... leaf ...)) with depth levels.
+TermPtr nested(std::size_t depth, TermPtr leaf) {
+    for (std::size_t i = 0; i < depth; ++i) {
+        leaf = builders::compound("s", std::move(leaf));
+    }
+    return leaf;
+}
+
+// Unification, the occurs check, substitution, cloning and destruction of 100k-deep
+// terms use explicit stacks, not recursion.
+void testDeepTerms() {
+    constexpr std::size_t kDepth = 100000;
+    TermPtr open = nested(kDepth, builders::var("X"));
+    TermPtr closed = nested(kDepth, builders::constant("z"));
+    Unifier unifier;
+    auto result = unifier.unify(*open, *closed);
+    CHECK(result.has_value());
+    if (result) {
+        CHECK_EQ(formatSubstitution(*result), "X -> z");
+    }
+
+    TermPtr x = builders::var("X");
+    CHECK(!unifier.unify(*x, *open).has_value());
+    CHECK(!unifier.unify(*open, *nested(kDepth + 1, builders::var("X"))).has_value());
+
+    Unifier::Substitution sub;
+    sub.emplace("X", nested(kDepth, builders::constant("z")));
+    TermPtr applied = unifier.substitute(*open, sub);
+    TermPtr copy = applied->clone();
+    std::size_t depth = 0;
+    const Term<std::string>* node = copy.get();
+    while (node->isCompound()) {
+        node = &termCast<Compound<std::string>>(*node).arg(0);
+        ++depth;
+    }
+    CHECK_EQ(depth, 2 * kDepth);
+    CHECK(unifier.match(*open, *applied).has_value());
+}
+
+// Formatted match(pattern, subject), or "failure".
+std::string matched(Unifier& unifier, const std::string& pattern, const std::string& subject) {
+    TermPtr p = parseTerm(pattern);
+    TermPtr s = parseTerm(subject);
+    auto result = unifier.match(*p, *s);
+    return result ? formatSubstitution(*result) : "failure";
+}
+
+// Matching binds pattern variables only; subject variables behave like constants.
+void testMatch() {
+    Unifier unifier;
+    CHECK_EQ(matched(unifier, "f(X, g(Y))", "f(a, g(h(b)))"), "X -> a, Y -> h(b)");
+    CHECK_EQ(matched(unifier, "f(X, X)", "f(g(Z), g(Z))"), "X -> g(Z)");
+    CHECK_EQ(matched(unifier, "f(X, X)", "f(g(Z), g(W))"), "failure");
+    CHECK_EQ(matched(unifier, "f(a, X)", "f(Z, b)"), "failure");
+    CHECK_EQ(matched(unifier, "f(X)", "f(X)"), "X -> X");
+    CHECK_EQ(matched(unifier, "X", "f(X)"), "X -> f(X)");
+    CHECK_EQ(matched(unifier, "f(X, b)", "f(a, b, c)"), "failure");
+    CHECK_EQ(unified(unifier, "f(a, X)", "f(Z, b)"), "X -> b, Z -> a");
+
+    TermPtr pattern = parseTerm("p(X, Y)");
+    TermPtr subject = parseTerm("p(q(a), b)");
+    auto shared = unifier.matchShared(*pattern, *subject);
+    CHECK(shared.has_value());
+    if (shared) {
+        CHECK_EQ(formatSubstitution(unifier.toOwned(*shared)), "X -> q(a), Y -> b");
+    }
+
+    // the lazy form extends bindings or leaves them as they were
+    Bindings bindings;
+    TermPtr first = parseTerm("p(X, c)");
+    TermPtr second = parseTerm("p(q(a), c)");
+    CHECK(unifier.match(*first, *second, bindings));
+    const Bindings::Mark mark = bindings.mark();
+    TermPtr clash = parseTerm("p(X, c)");
+    TermPtr other = parseTerm("p(b, c)");
+    CHECK(!unifier.match(*clash, *other, bindings));
+    CHECK(bindings.mark() == mark);
+    CHECK_EQ(formatTerm(*unifier.substitute(*first, bindings)), "p(q(a), c)");
+}
+
+// True if node is inside root (compared by address).
+bool within(const Term<std::string>& root, const Term<std::string>* node) {
+    std::vector<const Term<std::string>*> pending{&root};
+    while (!pending.empty()) {
+        const Term<std::string>* current = pending.back();
+        pending.pop_back();
+        if (current == node) {
+            return true;
+        }
+        if (current->isCompound()) {
+            const auto& comp = termCast<Compound<std::string>>(*current);
+            for (std::size_t i = 0; i < comp.arity(); ++i) {
+                pending.push_back(&comp.arg(i));
+            }
+        }
+    }
+    return false;
+}
+
+// Shared results point into the unified terms instead of copying them, and agree with
+// the owned results once applied.
+void testSharedResults() {
+    Unifier unifier;
+    TermPtr t1 = parseTerm("f(X, g(Y), Z)");
+    TermPtr t2 = parseTerm("f(h(a, b, c), W, W)");
+    auto shared = unifier.unifyShared(*t1, *t2);
+    CHECK(shared.has_value());
+    if (!shared) {
+        return;
+    }
+    bool pointsIn = true;
+    for (const auto& [name, value] : *shared) {
+        pointsIn = pointsIn && (within(*t1, value) || within(*t2, value));
+    }
+    CHECK(pointsIn);
+    const auto x = shared->find("X");
+    CHECK(x != shared->end() && x->second == &termCast<Compound<std::string>>(*t2).arg(0));
+
+    auto owned = unifier.unify(*t1, *t2);
+    CHECK(owned.has_value());
+    if (owned) {
+        CHECK_EQ(formatSubstitution(unifier.toOwned(*shared)), formatSubstitution(*owned));
+        CHECK_EQ(formatTerm(*unifier.substitute(*t1, *shared)),
+                 formatTerm(*unifier.substitute(*t1, *owned)));
+    }
+    CHECK_EQ(formatTerm(*unifier.substitute(*t2, *shared)), "f(h(a, b, c), g(Y), g(Y))");
+}
+
+// Compounds at and around kInlineArity, built every way, copy and move like any other.
+void testCompoundArity() {
+    using Comp = Compound<std::string>;
+    const std::size_t inlineArity = Comp::kInlineArity;
+    for (std::size_t arity : {std::size_t{0}, std::size_t{1}, inlineArity - 1, inlineArity,
+                              inlineArity + 1, 2 * inlineArity + 3}) {
+        std::string text = "f(";
+        std::vector<TermPtr> args;
+        std::vector<TermPtr> buffer;
+        for (std::size_t i = 0; i < arity; ++i) {
+            text += (i > 0 ? ", a" : "a") + std::to_string(i);
+            args.push_back(builders::constant("a" + std::to_string(i)));
+            buffer.push_back(builders::constant("a" + std::to_string(i)));
+        }
+        text += ")";
+
+        Comp built("f", std::move(args));
+        std::unique_ptr<Comp> made = Comp::makeFrom("f", buffer.data(), buffer.size());
+        CHECK_EQ(built.arity(), arity);
+        CHECK_EQ(formatTerm(built), text);
+        CHECK_EQ(formatTerm(*made), formatTerm(built));
+        if (arity > 0) {
+            CHECK_EQ(formatTerm(built.arg(arity - 1)), "a" + std::to_string(arity - 1));
+            CHECK(buffer[0] == nullptr);  // moved into the node
+        }
+        CHECK_THROWS(built.arg(arity), std::out_of_range);
+
+        Comp copy(built);
+        Comp moved(std::move(*made));
+        CHECK_EQ(formatTerm(moved), formatTerm(built));
+        CHECK_EQ(made->arity(), 0u);
+        Comp assigned("g", {});
+        assigned = copy;
+        CHECK_EQ(formatTerm(assigned), formatTerm(built));
+        assigned = std::move(moved);
+        CHECK_EQ(formatTerm(assigned), formatTerm(built));
+        CHECK_EQ(formatTerm(*built.clone()), formatTerm(built));
+        if (arity > 0) {
+            CHECK(&copy.arg(0) != &built.arg(0));
+        }
+    }
+
+    TermPtr five = builders::compound("h", builders::var("X"), builders::constant("b"),
+                                      builders::constant("c"), builders::constant("d"),
+                                      builders::compound("k", builders::var("Y")));
+    CHECK_EQ(formatTerm(*five), "h(X, b, c, d, k(Y))");
+    Unifier unifier;
+    CHECK_EQ(unified(unifier, "h(X, b, c, d, k(Y))", "h(a, b, c, d, k(e))"), "X -> a, Y -> e");
+}
+
+// unifyInto extends a substitution under its bindings and leaves it untouched on
+// failure; conjunctions go in whole or not at all.
+void testIncremental() {
+    Unifier unifier;
+    Unifier::Substitution sub;
+    sub.emplace("X", parseTerm("f(Y)"));
+    TermPtr y = parseTerm("Y");
+    TermPtr a = parseTerm("a");
+    CHECK(unifier.unifyInto(*y, *a, sub));
+    CHECK_EQ(formatSubstitution(sub), "X -> f(Y), Y -> a");
+
+    TermPtr x = parseTerm("X");
+    TermPtr fb = parseTerm("f(b)");
+    CHECK(!unifier.unifyInto(*x, *fb, sub));
+    CHECK_EQ(formatSubstitution(sub), "X -> f(Y), Y -> a");
+
+    TermPtr z = parseTerm("Z");
+    TermPtr gx = parseTerm("g(X)");
+    TermPtr w = parseTerm("W");
+    TermPtr zz = parseTerm("Z");
+    CHECK(!unifier.unifyInto({{z.get(), gx.get()}, {w.get(), a.get()}, {zz.get(), fb.get()}},
+                             sub));
+    CHECK_EQ(formatSubstitution(sub), "X -> f(Y), Y -> a");
+    CHECK(unifier.unifyInto({{z.get(), gx.get()}, {w.get(), zz.get()}}, sub));
+    CHECK_EQ(formatSubstitution(sub), "W -> g(f(a)), X -> f(Y), Y -> a, Z -> g(f(a))");
+
+    TermPtr fy = parseTerm("f(Y)");
+    TermPtr b = parseTerm("b");
+    CHECK(!unifier.unifyAll({{x.get(), fy.get()}, {y.get(), a.get()}, {x.get(), fb.get()}})
+               .has_value());
+    auto all = unifier.unifyAll({{x.get(), fy.get()}, {y.get(), b.get()}});
+    CHECK(all.has_value());
+    if (all) {
+        CHECK_EQ(formatSubstitution(*all), "X -> f(b), Y -> b");
+    }
+}
+
+// Counters count when the library is built with TERM_UNIFICATION_STATS and stay zero
+// otherwise; build this test both ways (-DTERM_UNIFICATION_STATS on every file) to cover both.
+void testStats() {
+    Unifier unifier;
+    CHECK_EQ(unified(unifier, "f(X, g(a))", "f(b, g(Y))"), "X -> b, Y -> a");
+    CHECK_EQ(unified(unifier, "f(a)", "f(b)"), "failure");
+    CHECK_EQ(unified(unifier, "f(a)", "g(a)"), "failure");
+    CHECK_EQ(unified(unifier, "f(a)", "f(a, b)"), "failure");
+    CHECK_EQ(unified(unifier, "a", "f(a)"), "failure");
+    CHECK_EQ(unified(unifier, "X", "f(X)"), "failure");
+    CHECK_EQ(matched(unifier, "f(X, X)", "f(a, b)"), "failure");
+    const UnifierStats stats = unifier.stats();
+#ifdef TERM_UNIFICATION_STATS
+    CHECK_EQ(stats.constantMismatches, 1u);
+    CHECK_EQ(stats.functorMismatches, 1u);
+    CHECK_EQ(stats.arityMismatches, 1u);
+    CHECK_EQ(stats.kindMismatches, 1u);
+    CHECK_EQ(stats.occursFailures, 1u);
+    CHECK_EQ(stats.repeatMismatches, 1u);
+    CHECK_EQ(stats.bindings, 3u);  // X and Y, then the first X of the match
+    CHECK_EQ(stats.clonedNodes, 2u);
+    CHECK(stats.steps >= 13u);
+    CHECK(stats.occursVisits >= 3u);
+#else
+    CHECK_EQ(stats.steps + stats.bindings + stats.occursVisits + stats.clonedNodes, 0u);
+    CHECK_EQ(stats.constantMismatches + stats.functorMismatches + stats.arityMismatches +
+                 stats.kindMismatches + stats.occursFailures + stats.repeatMismatches,
+             0u);
+#endif
+    unifier.resetStats();
+    CHECK_EQ(unifier.stats().steps, 0u);
+    CHECK_EQ(unifier.stats().bindings, 0u);
+}
+
+int main() {
+    testResolvedResults();
+    testDeferredOccursCheck();
+    testDispatch();
+    testTrail();
+    testDeepTerms();
+    testMatch();
+    testSharedResults();
+    testCompoundArity();
+    testIncremental();
+    testStats();
+    return testSummary();
+}